@@ -57,6 +57,15 @@ function(generate_headers)
             TYPE_NAME "RubiksCubeMtl"
     )
 
+    make_named_tuple(
+        OUTPUT_VARIABLE rubiks_cube_scene_arguments
+        PARAMETER_SET "${BATCH_STRINGIFY_FILES_CPP_PARAMETER_SET}"
+        ARGUMENTS
+            INPUT_FILE "${CMAKE_SOURCE_DIR}/assets/RubiksCube.scene"
+            OUTPUT_FILE "${GENERATED_HEADER_DIR}/RubiksCubeScene.h"
+            TYPE_NAME "RubiksCubeScene"
+    )
+
     batch_stringify_files(
         TARGET_NAME "${${prefix}_TARGET_NAME}"
         STRINGIFY_TOOL_TARGET_NAME "${${prefix}_STRINGIFY_TOOL_TARGET_NAME}"
@@ -66,5 +75,6 @@ function(generate_headers)
             "${fragment_shader_arguments}"
             "${rubiks_cube_model_arguments}"
             "${rubiks_cube_material_library_arguments}"
+            "${rubiks_cube_scene_arguments}"
     )
 endfunction()
@@ -0,0 +1,145 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+
+namespace ctoAssetsRTIS
+{
+struct CommandLineArguments
+{
+    const char* modelPath = nullptr;
+    const char* materialLibraryPath = nullptr;
+    const char* assetPackPath = nullptr;
+    const char* bakeAssetPackPath = nullptr;
+    const char* frameTimeReportPath = nullptr;
+    bool measureLatency = false;
+    bool syntheticInput = false;
+    const char* recordInputPath = nullptr;
+    const char* replayInputPath = nullptr;
+    size_t allocationCheckFrameCount = 0;
+
+    static constexpr auto usage =
+        "Usage: cto-assets-rtis"
+        " [model.obj materials.mtl | model.pack]"
+        " [--bake-asset-pack output.pack]"
+        " [--frame-time-report output.txt|-]"
+        " [--measure-latency] [--synthetic-input]"
+        " [--record-input output.input] [--replay-input input.input]"
+        " [--allocation-check frames]";
+
+    static CommandLineArguments parse(std::span<char*> arguments)
+    {
+        auto result = CommandLineArguments{};
+
+        auto positionalArguments = std::array<const char*, 2>{};
+        auto positionalArgumentsCount = size_t{};
+
+        for (auto i = size_t{ 1 }; i < arguments.size(); i++)
+        {
+            const auto argument = std::string_view(arguments[i]);
+
+            const auto takeValue =
+            [&]
+            {
+                if (++i >= arguments.size())
+                {
+                    throw std::invalid_argument(usage);
+                }
+
+                return arguments[i];
+            };
+
+            if (argument == "--bake-asset-pack")
+            {
+                result.bakeAssetPackPath = takeValue();
+                continue;
+            }
+
+            if (argument == "--frame-time-report")
+            {
+                result.frameTimeReportPath = takeValue();
+                continue;
+            }
+
+            if (argument == "--measure-latency")
+            {
+                result.measureLatency = true;
+                continue;
+            }
+
+            if (argument == "--synthetic-input")
+            {
+                result.syntheticInput = true;
+                continue;
+            }
+
+            if (argument == "--record-input")
+            {
+                result.recordInputPath = takeValue();
+                continue;
+            }
+
+            if (argument == "--replay-input")
+            {
+                result.replayInputPath = takeValue();
+                continue;
+            }
+
+            if (argument == "--allocation-check")
+            {
+                const auto value = std::string_view(takeValue());
+                const auto [end, error] =
+                    std::from_chars(
+                        value.data(),
+                        value.data() + value.size(),
+                        result.allocationCheckFrameCount);
+                if (error != std::errc()
+                    || end != value.data() + value.size()
+                    || result.allocationCheckFrameCount == 0)
+                {
+                    throw std::invalid_argument(usage);
+                }
+                continue;
+            }
+
+            if (argument.starts_with("--")
+                || positionalArgumentsCount == positionalArguments.size())
+            {
+                throw std::invalid_argument(usage);
+            }
+
+            positionalArguments[positionalArgumentsCount++] = arguments[i];
+        }
+
+        switch (positionalArgumentsCount)
+        {
+            case 0:
+                break;
+            case 1:
+                if (!std::string_view(positionalArguments[0])
+                    .ends_with(".pack"))
+                {
+                    throw std::invalid_argument(usage);
+                }
+                result.assetPackPath = positionalArguments[0];
+                break;
+            default:
+                result.modelPath = positionalArguments[0];
+                result.materialLibraryPath = positionalArguments[1];
+                break;
+        }
+
+        return result;
+    }
+};
+} // namespace ctoAssetsRTIS
@@ -36,6 +36,8 @@ private:
         return forwardVector;
     }
 public:
+    static constexpr auto restingSpeed = 1e-5f;
+
     struct CameraConfiguration
     {
         float radius;
@@ -60,7 +62,8 @@ public:
 
         return pitchQuaternion * yawQuaternion;
     }())
-    , position(0.0f, 0.0f, configuration.radius)
+    , previousOrientation{ this->orientation }
+    , interpolatedOrientation{ this->orientation }
     , velocity(0.0f, 0.0f, 0.0f)
     , radius{ configuration.radius }
     , rotationSensitivity{ configuration.rotationSensitivity }
@@ -73,11 +76,6 @@ public:
     Camera& operator=(const Camera&) = delete;
 
 private:
-    auto getCameraForwardVector() const
-    {
-        return this->orientation * -getGlobalForwardVector();
-    }
-
     template<typename VectorType>
     static auto isZeroVector(const VectorType& vector)
     {
@@ -105,6 +103,8 @@ public:
     {
         const auto dt = arguments.dt;
 
+        this->previousOrientation = this->orientation;
+
         const auto& inputStates = arguments.inputStates;
         this->processMouseInput(
             inputStates.mouseStates,
@@ -136,13 +136,42 @@ public:
             this->orientation = glm::normalize(this->orientation);
         }
 
-        this->position = -this->getCameraForwardVector() * radius;
-        if (glm::length(this->position) != radius)
+        this->velocity *= 1.0f - std::clamp(dampingFactor * dt, 0.0f, 1.0f);
+        if (glm::length(this->velocity) < restingSpeed)
         {
-            this->position = glm::normalize(this->position) * radius;
+            this->velocity = glm::vec3();
         }
+    }
 
-        this->velocity *= 1.0f - std::clamp(dampingFactor * dt, 0.0f, 1.0f);
+    // Damping only approaches zero, so speeds below restingSpeed, in radians
+    // per update, are treated as rest. The camera is at rest once it has
+    // also not turned in the last update.
+    bool isAtRest() const
+    {
+        return
+            isZeroVector(this->velocity)
+                && this->previousOrientation == this->orientation;
+    }
+
+    // Places the view between the orientations before and after the last
+    // update, with 0 the former and 1 the latter.
+    void setInterpolationFactor(float interpolationFactor)
+    {
+        const auto interpolatedOrientation =
+            glm::slerp(
+                this->previousOrientation,
+                this->orientation,
+                interpolationFactor);
+
+        this->viewChanged =
+            interpolatedOrientation != this->interpolatedOrientation;
+        this->interpolatedOrientation = interpolatedOrientation;
+    }
+
+    // Whether the last setInterpolationFactor moved the view.
+    bool hasViewChanged() const
+    {
+        return this->viewChanged;
     }
 
     void processMouseInput(
@@ -155,46 +184,7 @@ public:
             return;
         }
 
-        const auto cursorDidNotMove =
-        [&]
-        {
-            static auto previousCurrentCursorPosition = glm::vec2();
-
-            const auto cursorPositionDelta =
-                mouseStates.currentCursorPosition
-                    - previousCurrentCursorPosition;
-
-            previousCurrentCursorPosition = mouseStates.currentCursorPosition;
-
-
-            return isZeroVector(cursorPositionDelta);
-        }();
-
-        if (cursorDidNotMove)
-        {
-            return;
-        }
-
-        const auto clampToViewportDimensions =
-        [&](const auto& vector)
-        {
-            return
-                glm::clamp(
-                    vector,
-                    glm::vec2(),
-                    glm::vec2(
-                        viewportDimensions.getWidth(),
-                        viewportDimensions.getHeight()));
-        };
-
-        const auto clampedLastPosition =
-            clampToViewportDimensions(mouseStates.lastCursorPosition);
-
-        const auto clampedCurrentPosition =
-            clampToViewportDimensions(mouseStates.currentCursorPosition);
-
-        auto deltaVelocity =
-            glm::vec3(clampedLastPosition - clampedCurrentPosition, 0.0f);
+        auto deltaVelocity = glm::vec3(-mouseStates.cursorMotion, 0.0f);
 
         if (isZeroVector(deltaVelocity))
         {
@@ -267,16 +257,22 @@ public:
 
     auto getViewMatrix() const
     {
+        const auto forwardVector =
+            this->interpolatedOrientation * -getGlobalForwardVector();
+        const auto position = -forwardVector * this->radius;
+
         return glm::lookAt(
-            this->position,
-            this->position + this->getCameraForwardVector(),
-            this->orientation * getGlobalUpVector());
+            position,
+            position + forwardVector,
+            this->interpolatedOrientation * getGlobalUpVector());
     }
 
 private:
     glm::quat orientation;
-    glm::vec3 position;
+    glm::quat previousOrientation;
+    glm::quat interpolatedOrientation;
     glm::vec3 velocity;
+    bool viewChanged = false;
 
     float radius;
     float rotationSensitivity;
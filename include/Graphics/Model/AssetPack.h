@@ -0,0 +1,431 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/em_js.h>
+#endif
+
+#include "Materials/MaterialLibrary.h"
+#include "Mesh/MeshData.h"
+
+
+namespace ctoAssetsRTIS
+{
+class AssetPack
+{
+public:
+    static constexpr auto magic =
+        std::array<char, 8>{ 'C', 'T', 'O', 'P', 'A', 'C', 'K', '\0' };
+    static constexpr auto version = std::uint32_t{ 2 };
+    static constexpr auto blobAlignment = size_t{ 64 };
+    static constexpr auto nameCapacity = size_t{ 64 };
+
+    struct Header
+    {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t vertexStride;
+        std::uint64_t vertexBlobOffset;
+        std::uint64_t vertexBlobSize;
+        std::uint64_t indexBlobOffset;
+        std::uint64_t indexBlobSize;
+        std::uint64_t chunkTableOffset;
+        std::uint32_t chunkCount;
+        std::uint32_t attributeCount;
+        std::uint32_t materialCount;
+        std::uint32_t reserved;
+    };
+
+    struct ChunkEntry
+    {
+        std::array<char, nameCapacity> name;
+        std::uint64_t offset;
+        std::uint64_t count;
+        std::uint32_t primitiveMode;
+        std::uint32_t reserved;
+    };
+
+    struct AttributeEntry
+    {
+        std::uint32_t index;
+        std::int32_t elementCount;
+        std::uint32_t elementType;
+        std::uint32_t offset;
+    };
+
+    struct MaterialEntry
+    {
+        std::array<char, nameCapacity> name;
+        std::array<float, 3> diffuseColor;
+        std::uint32_t reserved;
+    };
+
+    static_assert(std::endian::native == std::endian::little);
+    static_assert(sizeof(Header) % alignof(ChunkEntry) == 0);
+    static_assert(sizeof(GLfloat) == sizeof(std::uint32_t));
+    static_assert(sizeof(GLuint) == sizeof(std::uint32_t));
+
+    AssetPack(std::span<const std::byte> bytes)
+    : bytes{ bytes }
+    , header{ readHeader(bytes) }
+    {
+        const auto chunkEntries =
+            this->readTable<ChunkEntry>(
+                this->header.chunkTableOffset,
+                this->header.chunkCount);
+
+        const auto attributeEntries =
+            this->readTable<AttributeEntry>(
+                this->header.chunkTableOffset
+                    + chunkEntries.size_bytes(),
+                this->header.attributeCount);
+
+        const auto materialEntries =
+            this->readTable<MaterialEntry>(
+                this->header.chunkTableOffset
+                    + chunkEntries.size_bytes()
+                    + attributeEntries.size_bytes(),
+                this->header.materialCount);
+
+        // Each check is arranged so that no crafted value can overflow it.
+        const auto indexCount = this->header.indexBlobSize / sizeof(GLuint);
+
+        this->materialChunks.reserve(chunkEntries.size());
+        for (const auto& chunkEntry : chunkEntries)
+        {
+            if (chunkEntry.offset > indexCount
+                || chunkEntry.count > indexCount - chunkEntry.offset)
+            {
+                throw std::runtime_error(
+                    "Invalid asset pack: chunk exceeds index blob");
+            }
+
+            if (chunkEntry.primitiveMode != GL_TRIANGLES
+                && chunkEntry.primitiveMode != GL_TRIANGLE_STRIP)
+            {
+                throw std::runtime_error(
+                    "Invalid asset pack: unsupported primitive mode");
+            }
+
+            this->materialChunks.push_back({
+                .name = readName(chunkEntry.name),
+                .offset = static_cast<size_t>(chunkEntry.offset),
+                .count = static_cast<size_t>(chunkEntry.count),
+                .primitiveMode = chunkEntry.primitiveMode
+            });
+        }
+
+        this->vertexAttributes.reserve(attributeEntries.size());
+        for (const auto& attributeEntry : attributeEntries)
+        {
+            this->vertexAttributes.push_back({
+                .index = attributeEntry.index,
+                .elementCount = attributeEntry.elementCount,
+                .elementType = attributeEntry.elementType,
+                .offset = attributeEntry.offset
+            });
+        }
+
+        this->materialDefinitions.reserve(materialEntries.size());
+        for (const auto& materialEntry : materialEntries)
+        {
+            this->materialDefinitions.push_back({
+                .name = readName(materialEntry.name),
+                .diffuseColor = materialEntry.diffuseColor
+            });
+        }
+    }
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack(AssetPack&&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    MeshData getMeshData() const
+    {
+        return
+            MeshData
+            {
+                .vertices =
+                    this->readBlob<GLfloat>(
+                        this->header.vertexBlobOffset,
+                        this->header.vertexBlobSize),
+                .faceIndices =
+                    this->readBlob<GLuint>(
+                        this->header.indexBlobOffset,
+                        this->header.indexBlobSize),
+                .materialChunks = this->materialChunks,
+                .vertexAttributes = this->vertexAttributes,
+                .vertexStride = this->header.vertexStride
+            };
+    }
+
+    std::span<const MaterialLibrary::Definition> getMaterialDefinitions() const
+    {
+        return this->materialDefinitions;
+    }
+
+    static void write(
+        std::ostream& stream,
+        const MeshData& meshData,
+        std::span<const MaterialLibrary::Definition> materialDefinitions)
+    {
+        const auto alignUp =
+        [](std::uint64_t offset, std::uint64_t alignment)
+        {
+            return (offset + alignment - 1) / alignment * alignment;
+        };
+
+        const auto writeName =
+        [](std::string_view name)
+        {
+            if (name.size() >= nameCapacity)
+            {
+                throw std::runtime_error(
+                    std::format("Asset pack name too long: {}", name));
+            }
+
+            auto result = std::array<char, nameCapacity>{};
+            std::copy(name.begin(), name.end(), result.begin());
+            return result;
+        };
+
+        auto header = Header{};
+        header.magic = magic;
+        header.version = version;
+        header.vertexStride = meshData.vertexStride;
+        header.vertexBlobOffset = alignUp(sizeof(Header), blobAlignment);
+        header.vertexBlobSize = meshData.vertices.size_bytes();
+        header.indexBlobOffset =
+            alignUp(
+                header.vertexBlobOffset + header.vertexBlobSize,
+                blobAlignment);
+        header.indexBlobSize = meshData.faceIndices.size_bytes();
+        header.chunkTableOffset =
+            alignUp(
+                header.indexBlobOffset + header.indexBlobSize,
+                blobAlignment);
+        header.chunkCount =
+            static_cast<std::uint32_t>(meshData.materialChunks.size());
+        header.attributeCount =
+            static_cast<std::uint32_t>(meshData.vertexAttributes.size());
+        header.materialCount =
+            static_cast<std::uint32_t>(materialDefinitions.size());
+
+        auto position = std::uint64_t{};
+        const auto writeBytes =
+        [&](const void* data, std::uint64_t size)
+        {
+            stream.write(
+                static_cast<const char*>(data),
+                static_cast<std::streamsize>(size));
+            position += size;
+        };
+
+        const auto padTo =
+        [&](std::uint64_t offset)
+        {
+            static constexpr auto padding = std::array<char, blobAlignment>{};
+            writeBytes(padding.data(), offset - position);
+        };
+
+        writeBytes(&header, sizeof(header));
+
+        padTo(header.vertexBlobOffset);
+        writeBytes(meshData.vertices.data(), header.vertexBlobSize);
+
+        padTo(header.indexBlobOffset);
+        writeBytes(meshData.faceIndices.data(), header.indexBlobSize);
+
+        padTo(header.chunkTableOffset);
+        for (const auto& materialChunk : meshData.materialChunks)
+        {
+            const auto chunkEntry =
+                ChunkEntry
+                {
+                    .name = writeName(materialChunk.name),
+                    .offset = materialChunk.offset,
+                    .count = materialChunk.count,
+                    .primitiveMode = materialChunk.primitiveMode,
+                    .reserved = 0
+                };
+            writeBytes(&chunkEntry, sizeof(chunkEntry));
+        }
+
+        for (const auto& vertexAttribute : meshData.vertexAttributes)
+        {
+            const auto attributeEntry =
+                AttributeEntry
+                {
+                    .index = vertexAttribute.index,
+                    .elementCount = vertexAttribute.elementCount,
+                    .elementType = vertexAttribute.elementType,
+                    .offset =
+                        static_cast<std::uint32_t>(vertexAttribute.offset)
+                };
+            writeBytes(&attributeEntry, sizeof(attributeEntry));
+        }
+
+        for (const auto& materialDefinition : materialDefinitions)
+        {
+            const auto materialEntry =
+                MaterialEntry
+                {
+                    .name = writeName(materialDefinition.name),
+                    .diffuseColor = materialDefinition.diffuseColor,
+                    .reserved = 0
+                };
+            writeBytes(&materialEntry, sizeof(materialEntry));
+        }
+
+        if (!stream)
+        {
+            throw std::runtime_error("Failed to write asset pack");
+        }
+    }
+
+private:
+    static Header readHeader(std::span<const std::byte> bytes)
+    {
+        if (bytes.size() < sizeof(Header))
+        {
+            throw std::runtime_error("Invalid asset pack: truncated header");
+        }
+
+        if (reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(Header))
+        {
+            throw std::runtime_error("Invalid asset pack: misaligned data");
+        }
+
+        auto header = Header{};
+        std::memcpy(&header, bytes.data(), sizeof(Header));
+
+        if (header.magic != magic)
+        {
+            throw std::runtime_error("Invalid asset pack: bad magic");
+        }
+
+        if (header.version != version)
+        {
+            throw std::runtime_error(
+                std::format(
+                    "Unsupported asset pack version: {}",
+                    header.version));
+        }
+
+        return header;
+    }
+
+    static std::string_view readName(
+        const std::array<char, nameCapacity>& name)
+    {
+        return
+            std::string_view(
+                name.data(),
+                std::find(name.begin(), name.end(), '\0') - name.begin());
+    }
+
+    template<typename T>
+    std::span<const T> readBlob(
+        std::uint64_t offset,
+        std::uint64_t sizeBytes) const
+    {
+        if (offset % alignof(T) != 0
+            || sizeBytes % sizeof(T) != 0
+            || offset > this->bytes.size()
+            || sizeBytes > this->bytes.size() - offset)
+        {
+            throw std::runtime_error("Invalid asset pack: bad blob range");
+        }
+
+        return
+            std::span(
+                reinterpret_cast<const T*>(this->bytes.data() + offset),
+                static_cast<size_t>(sizeBytes / sizeof(T)));
+    }
+
+    template<typename T>
+    std::span<const T> readTable(
+        std::uint64_t offset,
+        std::uint64_t count) const
+    {
+        if (count > this->bytes.size() / sizeof(T))
+        {
+            throw std::runtime_error("Invalid asset pack: bad table size");
+        }
+
+        return this->readBlob<T>(offset, count * sizeof(T));
+    }
+
+    const std::span<const std::byte> bytes;
+    const Header header;
+
+    std::vector<MeshData::MaterialChunk> materialChunks;
+    std::vector<VertexAttribute> vertexAttributes;
+    std::vector<MaterialLibrary::Definition> materialDefinitions;
+};
+
+#ifdef __EMSCRIPTEN__
+// The page fetches the pack alongside the Wasm binary and holds startup
+// until it arrives, leaving it on Module; see index.html.in.
+EM_JS(size_t, getPreloadedAssetPackSize, (), {
+    const assetPack = Module['assetPack'];
+    return assetPack ? assetPack.length : 0;
+});
+
+EM_JS(void, takePreloadedAssetPack, (void* data), {
+    HEAPU8.set(Module['assetPack'], data);
+    delete Module['assetPack'];
+});
+
+// Copies the asset pack the page preloaded into the heap, so a new pack
+// can be deployed without rebuilding the Wasm binary. Empty if the page
+// found none.
+class PreloadedAssetPack
+{
+public:
+    PreloadedAssetPack()
+    : size{ getPreloadedAssetPackSize() }
+    {
+        if (this->size == 0)
+        {
+            return;
+        }
+
+        this->data = std::make_unique_for_overwrite<std::byte[]>(this->size);
+        takePreloadedAssetPack(this->data.get());
+    }
+
+    PreloadedAssetPack(const PreloadedAssetPack&) = delete;
+    PreloadedAssetPack(PreloadedAssetPack&&) = delete;
+    PreloadedAssetPack& operator=(const PreloadedAssetPack&) = delete;
+
+    std::span<const std::byte> getBytes() const
+    {
+        return { this->data.get(), this->size };
+    }
+
+private:
+    size_t size;
+    std::unique_ptr<std::byte[]> data;
+};
+#endif
+} // namespace ctoAssetsRTIS
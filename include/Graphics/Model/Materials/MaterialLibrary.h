@@ -10,9 +10,14 @@
 #include <array>
 #include <format>
 #include <stdexcept>
+#include <string>
 #include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <vector>
+
+#include "Serialization/Deserialize.h"
+#include "Serialization/RuntimeParseStructuredSequentialData.h"
 
 namespace ctoAssetsRTIS
 {
@@ -51,6 +56,11 @@ public:
         return *materialDefinitionsIterator;
     }
 
+    auto getDefinitions() const
+    {
+        return this->materialDefinitions;
+    }
+
 private:
     const std::span<const Definition> materialDefinitions;
 };
@@ -105,4 +115,56 @@ private:
 public:
     static constexpr auto value = MaterialLibrary(materialDefinitions);
 };
+
+template<>
+class RuntimeDeserialize<MaterialLibrary>
+{
+public:
+    RuntimeDeserialize(std::string_view contents)
+    {
+        const auto parsedMaterialDefinitions =
+            RuntimeParseWavefrontMtl::parse(contents);
+
+        const auto& elements = parsedMaterialDefinitions.elements;
+
+        this->materialNames.reserve(elements.size());
+        this->materialDefinitions.reserve(elements.size());
+
+        for (const auto& materialDefinition : elements)
+        {
+            const auto& diffuseColors =
+                std::get<0>(materialDefinition.fields).values;
+
+            if (diffuseColors.empty())
+            {
+                throw
+                    std::runtime_error(
+                        std::format(
+                            "Material has no diffuse color: {}",
+                            materialDefinition.id));
+            }
+
+            const auto& name =
+                this->materialNames.emplace_back(materialDefinition.id);
+
+            this->materialDefinitions.push_back({
+                .name = name,
+                .diffuseColor = diffuseColors[0]
+            });
+        }
+    }
+
+    RuntimeDeserialize(const RuntimeDeserialize&) = delete;
+    RuntimeDeserialize(RuntimeDeserialize&&) = delete;
+    RuntimeDeserialize& operator=(const RuntimeDeserialize&) = delete;
+
+    std::span<const MaterialLibrary::Definition> getValue() const
+    {
+        return this->materialDefinitions;
+    }
+
+private:
+    std::vector<std::string> materialNames;
+    std::vector<MaterialLibrary::Definition> materialDefinitions;
+};
 } // namespace ctoAssetsRTIS
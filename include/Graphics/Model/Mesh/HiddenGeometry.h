@@ -0,0 +1,257 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <span>
+
+#include "TriangleBvh.h"
+
+
+namespace ctoAssetsRTIS
+{
+// A triangle is hidden when, for every sampled view direction, rays from its
+// centroid and from the midpoints between centroid and corners all hit other
+// geometry. Directions point at the lattice points on the surface of a cube,
+// which covers the sphere without trigonometry.
+class HiddenGeometry
+{
+public:
+    static constexpr auto removedVertex =
+        std::numeric_limits<unsigned int>::max();
+
+    template<size_t TriangleCount>
+    static constexpr auto findVisibleTriangles(
+        std::span<const float> vertices,
+        size_t vertexStride,
+        std::span<const unsigned int> faceIndices)
+    {
+        const auto bvh =
+            TriangleBvh<TriangleCount>(vertices, vertexStride, faceIndices);
+
+        const auto& root = bvh.getRoot();
+        auto extent = 0.0f;
+        for (auto axis = size_t{}; axis < 3; axis++)
+        {
+            extent = std::max(extent, root.maximum[axis] - root.minimum[axis]);
+        }
+
+        const auto rayOffset = extent * 1e-5f;
+
+        auto result = std::array<bool, TriangleCount>{};
+        for (auto triangle = size_t{}; triangle < TriangleCount; triangle++)
+        {
+            const auto& corners = bvh.getCorners(triangle);
+
+            auto samples = std::array<std::array<float, 3>, 4>{};
+            for (auto axis = size_t{}; axis < 3; axis++)
+            {
+                samples[0][axis] =
+                    (corners[0][axis] + corners[1][axis] + corners[2][axis])
+                        / 3.0f;
+
+                for (auto corner = size_t{}; corner < 3; corner++)
+                {
+                    samples[corner + 1][axis] =
+                        (samples[0][axis] + corners[corner][axis]) / 2.0f;
+                }
+            }
+
+            for (auto i = size_t{}; i < directions.size() && !result[triangle];
+                i++)
+            {
+                const auto& direction = directions[i];
+                const auto longestComponent =
+                    std::max({
+                        direction[0] < 0.0f ? -direction[0] : direction[0],
+                        direction[1] < 0.0f ? -direction[1] : direction[1],
+                        direction[2] < 0.0f ? -direction[2] : direction[2]
+                    });
+
+                for (const auto& sample : samples)
+                {
+                    const auto ray =
+                        typename TriangleBvh<TriangleCount>::Ray
+                        {
+                            .origin = sample,
+                            .direction = direction,
+                            .minimumDistance = rayOffset / longestComponent
+                        };
+
+                    if (!bvh.intersectsAny(ray, triangle))
+                    {
+                        result[triangle] = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // Maps each vertex referenced by a visible triangle to its index in the
+    // compacted vertex stream, preserving order; other vertices map to
+    // removedVertex.
+    template<size_t VertexCount, size_t TriangleCount>
+    static constexpr auto makeVertexRemap(
+        const std::array<bool, TriangleCount>& visibleTriangles,
+        std::span<const unsigned int> faceIndices)
+    {
+        auto result = std::array<unsigned int, VertexCount>{};
+        result.fill(removedVertex);
+
+        for (auto triangle = size_t{}; triangle < TriangleCount; triangle++)
+        {
+            if (!visibleTriangles[triangle])
+            {
+                continue;
+            }
+
+            for (auto corner = size_t{}; corner < 3; corner++)
+            {
+                result[faceIndices[triangle * 3 + corner]] = 0;
+            }
+        }
+
+        auto nextIndex = 0u;
+        for (auto& index : result)
+        {
+            if (index != removedVertex)
+            {
+                index = nextIndex++;
+            }
+        }
+
+        return result;
+    }
+
+    template<size_t Size, size_t VertexCount>
+    static constexpr auto compactVertices(
+        std::span<const float> vertices,
+        size_t vertexStride,
+        const std::array<unsigned int, VertexCount>& vertexRemap)
+    {
+        auto result = std::array<float, Size>{};
+
+        for (auto vertex = size_t{}; vertex < VertexCount; vertex++)
+        {
+            const auto index = vertexRemap[vertex];
+            if (index == removedVertex)
+            {
+                continue;
+            }
+
+            std::copy_n(
+                vertices.begin() + vertex * vertexStride,
+                vertexStride,
+                result.begin() + index * vertexStride);
+        }
+
+        return result;
+    }
+
+    template<size_t Size, size_t TriangleCount, size_t VertexCount>
+    static constexpr auto compactFaceIndices(
+        std::span<const unsigned int> faceIndices,
+        const std::array<bool, TriangleCount>& visibleTriangles,
+        const std::array<unsigned int, VertexCount>& vertexRemap)
+    {
+        auto result = std::array<unsigned int, Size>{};
+
+        auto offset = size_t{};
+        for (auto triangle = size_t{}; triangle < TriangleCount; triangle++)
+        {
+            if (!visibleTriangles[triangle])
+            {
+                continue;
+            }
+
+            for (auto corner = size_t{}; corner < 3; corner++)
+            {
+                result[offset++] =
+                    vertexRemap[faceIndices[triangle * 3 + corner]];
+            }
+        }
+
+        return result;
+    }
+
+    template<typename MaterialChunk, size_t ChunkCount, size_t TriangleCount>
+    static constexpr auto compactMaterialChunks(
+        const std::array<MaterialChunk, ChunkCount>& materialChunks,
+        const std::array<bool, TriangleCount>& visibleTriangles)
+    {
+        auto result = materialChunks;
+
+        auto offset = size_t{};
+        for (auto& materialChunk : result)
+        {
+            const auto firstTriangle = materialChunk.offset / 3;
+            const auto triangleCount = materialChunk.count / 3;
+
+            materialChunk.offset = offset;
+            materialChunk.count =
+                static_cast<size_t>(
+                    std::count(
+                        visibleTriangles.begin() + firstTriangle,
+                        visibleTriangles.begin()
+                            + firstTriangle + triangleCount,
+                        true)) * 3;
+
+            offset += materialChunk.count;
+        }
+
+        return result;
+    }
+
+private:
+    static constexpr auto directionResolution = 2;
+
+    static constexpr auto directions =
+    []
+    {
+        constexpr auto side = directionResolution * 2 + 1;
+        constexpr auto innerSide = side - 2;
+
+        auto result =
+            std::array<
+                std::array<float, 3>,
+                side * side * side - innerSide * innerSide * innerSide
+            >{};
+
+        auto count = size_t{};
+        for (auto x = -directionResolution; x <= directionResolution; x++)
+        {
+            for (auto y = -directionResolution; y <= directionResolution; y++)
+            {
+                for (auto z = -directionResolution; z <= directionResolution;
+                    z++)
+                {
+                    if (std::max({ x, y, z, -x, -y, -z })
+                        != directionResolution)
+                    {
+                        continue;
+                    }
+
+                    result[count++] =
+                        {
+                            static_cast<float>(x),
+                            static_cast<float>(y),
+                            static_cast<float>(z)
+                        };
+                }
+            }
+        }
+
+        return result;
+    }();
+};
+} // namespace ctoAssetsRTIS
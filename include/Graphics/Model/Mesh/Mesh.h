@@ -7,6 +7,7 @@
 #pragma once
 
 #include <span>
+#include <vector>
 
 #include "Graphics/Rendering/GLObject.h"
 #include "MeshData.h"
@@ -19,15 +20,29 @@ public:
     Mesh(MeshData meshData)
     : materialChunks{ meshData.materialChunks }
     {
-        const auto vaoContext = this->vertexArray.bind();
-        const auto vboContext = this->vertexBuffer.bind();
-        const auto eboContext = this->elementBuffer.bind();
+        this->upload(meshData);
+    }
 
-        vboContext.bufferData(meshData.vertices);
-        eboContext.bufferData(meshData.faceIndices);
-        vaoContext.configureAttributes(
-            meshData.vertexStride,
-            meshData.vertexAttributes);
+    Mesh(EncodedMeshData encodedMeshData)
+    : materialChunks{ encodedMeshData.materialChunks }
+    {
+        auto vertices =
+            std::vector<GLfloat>(encodedMeshData.vertices.wordCount);
+        auto faceIndices =
+            std::vector<GLuint>(encodedMeshData.faceIndices.wordCount);
+
+        StreamEncoding::decode(encodedMeshData.vertices, std::span(vertices));
+        StreamEncoding::decode(
+            encodedMeshData.faceIndices,
+            std::span(faceIndices));
+
+        this->upload({
+            .vertices = vertices,
+            .faceIndices = faceIndices,
+            .materialChunks = encodedMeshData.materialChunks,
+            .vertexAttributes = encodedMeshData.vertexAttributes,
+            .vertexStride = encodedMeshData.vertexStride
+        });
     }
 
     Mesh(const Mesh&) = delete;
@@ -59,6 +74,19 @@ public:
     const std::span<const MeshData::MaterialChunk> materialChunks;
 
 private:
+    void upload(const MeshData& meshData) const
+    {
+        const auto vaoContext = this->vertexArray.bind();
+        const auto vboContext = this->vertexBuffer.bind();
+        const auto eboContext = this->elementBuffer.bind();
+
+        vboContext.bufferData(meshData.vertices);
+        eboContext.bufferData(meshData.faceIndices);
+        vaoContext.configureAttributes(
+            meshData.vertexStride,
+            meshData.vertexAttributes);
+    }
+
     const GLVertexArray vertexArray;
     const GLVertexBuffer vertexBuffer;
     const GLElementBuffer elementBuffer;
@@ -0,0 +1,316 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "TriangleBvh.h"
+#include "Window/ViewportDimensions.h"
+
+
+namespace ctoAssetsRTIS
+{
+// Closest-hit ray queries against a flattened bounding volume hierarchy,
+// typically built at compile time by CompileTimeMeshBvh.
+struct MeshBvh
+{
+    struct Ray
+    {
+        glm::vec3 origin;
+        glm::vec3 direction;
+
+        struct CursorProperties
+        {
+            glm::vec2 cursorPosition;
+            ViewportDimensions viewportDimensions;
+            const glm::mat4& viewMatrix;
+            const glm::mat4& projectionMatrix;
+        };
+        // From the near to the far plane through the cursor, so distances
+        // along the ray are fractions of the view depth.
+        static Ray fromCursor(CursorProperties properties)
+        {
+            const auto& [
+                cursorPosition,
+                viewportDimensions,
+                viewMatrix,
+                projectionMatrix
+            ] = properties;
+
+            const auto x =
+                2.0f * cursorPosition.x
+                    / static_cast<float>(viewportDimensions.getWidth())
+                    - 1.0f;
+            const auto y =
+                1.0f
+                    - 2.0f * cursorPosition.y
+                        / static_cast<float>(viewportDimensions.getHeight());
+
+            const auto inverseViewProjection =
+                glm::inverse(projectionMatrix * viewMatrix);
+
+            const auto unproject =
+            [&](float depth)
+            {
+                const auto point =
+                    inverseViewProjection * glm::vec4(x, y, depth, 1.0f);
+
+                return glm::vec3(point) / point.w;
+            };
+
+            const auto nearPoint = unproject(-1.0f);
+
+            return
+                Ray
+                {
+                    .origin = nearPoint,
+                    .direction = unproject(1.0f) - nearPoint
+                };
+        }
+
+        Ray transformed(const glm::mat4& matrix) const
+        {
+            return
+                Ray
+                {
+                    .origin = glm::vec3(matrix * glm::vec4(this->origin, 1.0f)),
+                    .direction =
+                        glm::vec3(matrix * glm::vec4(this->direction, 0.0f))
+                };
+        }
+    };
+
+    // Distances are in units of the ray direction, and so are preserved by
+    // Ray::transformed.
+    struct Hit
+    {
+        size_t triangle;
+        float distance;
+        glm::vec3 point;
+    };
+
+    std::optional<Hit> intersect(
+        const Ray& ray,
+        float maximumDistance = 1.0f) const
+    {
+        const auto inverseDirection = 1.0f / ray.direction;
+
+        const auto intersectBox =
+        [&](const BvhNode& node)
+        {
+            auto nearDistance = 0.0f;
+            auto farDistance = maximumDistance;
+            for (auto axis = 0; axis < 3; axis++)
+            {
+                auto entry =
+                    (node.minimum[axis] - ray.origin[axis])
+                        * inverseDirection[axis];
+                auto exit =
+                    (node.maximum[axis] - ray.origin[axis])
+                        * inverseDirection[axis];
+                if (entry > exit)
+                {
+                    std::swap(entry, exit);
+                }
+
+                nearDistance = entry > nearDistance ? entry : nearDistance;
+                farDistance = exit < farDistance ? exit : farDistance;
+            }
+
+            return
+                nearDistance <= farDistance
+                    ? nearDistance
+                    : std::numeric_limits<float>::infinity();
+        };
+
+        auto result = std::optional<Hit>();
+
+        auto pendingNodes = std::array<std::uint32_t, stackSize>{};
+        auto pendingCount = size_t{};
+        if (intersectBox(this->nodes[0]) <= maximumDistance)
+        {
+            pendingNodes[pendingCount++] = 0;
+        }
+
+        while (pendingCount > 0)
+        {
+            const auto& node = this->nodes[pendingNodes[--pendingCount]];
+
+            if (node.count == 0)
+            {
+                auto nearChild = node.offset;
+                auto farChild = node.offset + 1;
+                auto nearDistance = intersectBox(this->nodes[nearChild]);
+                auto farDistance = intersectBox(this->nodes[farChild]);
+                if (farDistance < nearDistance)
+                {
+                    std::swap(nearChild, farChild);
+                    std::swap(nearDistance, farDistance);
+                }
+
+                if (farDistance <= maximumDistance)
+                {
+                    pendingNodes[pendingCount++] = farChild;
+                }
+
+                if (nearDistance <= maximumDistance)
+                {
+                    pendingNodes[pendingCount++] = nearChild;
+                }
+
+                continue;
+            }
+
+            for (auto i = node.offset; i < node.offset + node.count; i++)
+            {
+                const auto triangle = this->triangleOrder[i];
+                const auto distance =
+                    this->intersectTriangle(ray, triangle, maximumDistance);
+
+                if (distance)
+                {
+                    maximumDistance = *distance;
+                    result =
+                        Hit
+                        {
+                            .triangle = triangle,
+                            .distance = *distance,
+                            .point = ray.origin + ray.direction * *distance
+                        };
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // Triangles cannot be located within strips, so any strip chunk makes
+    // the lookup fail.
+    template<typename MaterialChunk>
+    static std::optional<size_t> findMaterialChunk(
+        std::span<const MaterialChunk> materialChunks,
+        size_t triangle)
+    {
+        for (auto i = size_t{}; i < materialChunks.size(); i++)
+        {
+            const auto& materialChunk = materialChunks[i];
+            if (materialChunk.primitiveMode != GL_TRIANGLES)
+            {
+                return std::nullopt;
+            }
+
+            if (triangle >= materialChunk.offset / 3
+                && triangle < (materialChunk.offset + materialChunk.count) / 3)
+            {
+                return i;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::span<const BvhNode> nodes;
+    std::span<const std::uint32_t> triangleOrder;
+    std::span<const GLfloat> vertices;
+    std::span<const GLuint> faceIndices;
+    size_t vertexStride;
+
+    static constexpr auto stackSize = size_t{ 64 };
+
+private:
+    glm::vec3 getPosition(GLuint vertex) const
+    {
+        const auto* position = &this->vertices[vertex * this->vertexStride];
+
+        return glm::vec3(position[0], position[1], position[2]);
+    }
+
+    // Möller–Trumbore.
+    std::optional<float> intersectTriangle(
+        const Ray& ray,
+        size_t triangle,
+        float maximumDistance) const
+    {
+        const auto corner0 = this->getPosition(this->faceIndices[triangle * 3]);
+        const auto edge1 =
+            this->getPosition(this->faceIndices[triangle * 3 + 1]) - corner0;
+        const auto edge2 =
+            this->getPosition(this->faceIndices[triangle * 3 + 2]) - corner0;
+
+        const auto p = glm::cross(ray.direction, edge2);
+        const auto determinant = glm::dot(edge1, p);
+        if (determinant == 0.0f)
+        {
+            return std::nullopt;
+        }
+
+        const auto inverseDeterminant = 1.0f / determinant;
+        const auto s = ray.origin - corner0;
+
+        const auto u = glm::dot(s, p) * inverseDeterminant;
+        if (u < 0.0f || u > 1.0f)
+        {
+            return std::nullopt;
+        }
+
+        const auto q = glm::cross(s, edge1);
+        const auto v = glm::dot(ray.direction, q) * inverseDeterminant;
+        if (v < 0.0f || u + v > 1.0f)
+        {
+            return std::nullopt;
+        }
+
+        const auto distance = glm::dot(edge2, q) * inverseDeterminant;
+        if (distance < 0.0f || distance >= maximumDistance)
+        {
+            return std::nullopt;
+        }
+
+        return distance;
+    }
+};
+
+template<auto& Vertices, size_t VertexStride, auto& FaceIndices>
+class CompileTimeMeshBvh
+{
+private:
+    static constexpr auto builder =
+        TriangleBvh<FaceIndices.size() / 3>(
+            Vertices,
+            VertexStride,
+            FaceIndices);
+
+    static_assert(
+        builder.getDepth() < MeshBvh::stackSize,
+        "Bounding volume hierarchy is too deep to traverse");
+
+    static constexpr auto nodes =
+        builder.template getNodes<builder.getNodeCount()>();
+
+    static constexpr auto triangleOrder = builder.getTriangleOrder();
+
+public:
+    static constexpr auto value =
+        MeshBvh
+        {
+            .nodes = nodes,
+            .triangleOrder = triangleOrder,
+            .vertices = Vertices,
+            .faceIndices = FaceIndices,
+            .vertexStride = VertexStride
+        };
+};
+} // namespace ctoAssetsRTIS
@@ -6,14 +6,24 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
-#include <tuple>
+#include <cstdint>
+#include <string>
 #include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "HiddenGeometry.h"
+#include "MeshBvh.h"
+#include "MeshProcessingOptions.h"
+#include "TriangleStrips.h"
 #include "Serialization/Deserialize.h"
 #include "Serialization/ParseStructuredSequentialData.h"
+#include "Serialization/RuntimeParseStructuredSequentialData.h"
+#include "Serialization/StreamEncoding.h"
 #include "Vertex.h"
 
 namespace ctoAssetsRTIS
@@ -25,6 +35,7 @@ struct MeshData
         std::string_view name;
         size_t offset;
         size_t count;
+        GLenum primitiveMode = GL_TRIANGLES;
     };
 
     const std::span<const GLfloat> vertices;
@@ -34,6 +45,15 @@ struct MeshData
     const GLuint vertexStride;
 };
 
+struct EncodedMeshData
+{
+    const EncodedStream<GLfloat> vertices;
+    const EncodedStream<GLuint> faceIndices;
+    const std::span<const MeshData::MaterialChunk> materialChunks;
+    const std::span<const VertexAttribute> vertexAttributes;
+    const GLuint vertexStride;
+};
+
 class Mesh;
 
 template<typename StringProvider>
@@ -132,7 +152,9 @@ private:
 
 public:
     using VertexType = Vertex<Position>;
-    static constexpr auto vertices =
+
+private:
+    static constexpr auto parsedVertices =
     []
     {
         return
@@ -151,7 +173,7 @@ public:
                 }));
     }();
 
-    static constexpr auto faceIndices =
+    static constexpr auto parsedFaceIndices =
     []
     {
         const auto facesArray =
@@ -192,7 +214,7 @@ public:
         return result;
     }();
 
-    static constexpr auto materialChunks =
+    static constexpr auto parsedMaterialChunks =
     []
     {
         constexpr auto useMaterialDirectives = extractUseMaterialDirectives();
@@ -257,15 +279,313 @@ public:
         return result;
     }();
 
+public:
+    static constexpr auto options = getMeshProcessingOptions<StringProvider>();
+
+private:
+    static constexpr auto vertexElementCount = VertexType::elementCount;
+
+    static constexpr auto parsedVertexCount =
+        parsedVertices.size() / vertexElementCount;
+
+public:
+    // As parsed, before any triangles are removed.
+    static constexpr auto parsedTriangleCount = parsedFaceIndices.size() / 3;
+
+private:
+
+    static constexpr auto visibleTriangles =
+    []
+    {
+        if constexpr (options.removeHiddenGeometry)
+        {
+            return
+                HiddenGeometry::findVisibleTriangles<parsedTriangleCount>(
+                    parsedVertices,
+                    vertexElementCount,
+                    parsedFaceIndices);
+        }
+        else
+        {
+            auto result = std::array<bool, parsedTriangleCount>{};
+            result.fill(true);
+
+            return result;
+        }
+    }();
+
+    static constexpr auto vertexRemap =
+        HiddenGeometry::makeVertexRemap<parsedVertexCount>(
+            visibleTriangles,
+            parsedFaceIndices);
+
+public:
+    static constexpr auto hiddenTriangleCount =
+        static_cast<size_t>(
+            std::count(
+                visibleTriangles.begin(),
+                visibleTriangles.end(),
+                false));
+
+    static constexpr auto vertices =
+    []
+    {
+        if constexpr (options.removeHiddenGeometry)
+        {
+            constexpr auto vertexCount =
+                static_cast<size_t>(
+                    std::count_if(
+                        vertexRemap.begin(),
+                        vertexRemap.end(),
+                        [](unsigned int index)
+                        {
+                            return index != HiddenGeometry::removedVertex;
+                        }));
+
+            return
+                HiddenGeometry::compactVertices<
+                    vertexCount * vertexElementCount
+                >(parsedVertices, vertexElementCount, vertexRemap);
+        }
+        else
+        {
+            return parsedVertices;
+        }
+    }();
+
+private:
+    static constexpr auto triangleIndices =
+    []
+    {
+        if constexpr (options.removeHiddenGeometry)
+        {
+            return
+                HiddenGeometry::compactFaceIndices<
+                    (parsedTriangleCount - hiddenTriangleCount) * 3
+                >(parsedFaceIndices, visibleTriangles, vertexRemap);
+        }
+        else
+        {
+            return parsedFaceIndices;
+        }
+    }();
+
+    static constexpr auto triangleMaterialChunks =
+        HiddenGeometry::compactMaterialChunks(
+            parsedMaterialChunks,
+            visibleTriangles);
+
+    static constexpr auto stripification =
+    []
+    {
+        if constexpr (options.stripifyTriangles)
+        {
+            return
+                TriangleStrips::stripify(
+                    triangleIndices,
+                    triangleMaterialChunks);
+        }
+        else
+        {
+            return TriangleStrips::Result<MeshData::MaterialChunk, 0, 0>{};
+        }
+    }();
+
+public:
+    static constexpr auto faceIndices =
+    []
+    {
+        if constexpr (options.stripifyTriangles)
+        {
+            return
+                TriangleStrips::truncate<stripification.indexCount>(
+                    stripification.indices);
+        }
+        else
+        {
+            return triangleIndices;
+        }
+    }();
+
+    static constexpr auto materialChunks =
+    []
+    {
+        if constexpr (options.stripifyTriangles)
+        {
+            return stripification.materialChunks;
+        }
+        else
+        {
+            return triangleMaterialChunks;
+        }
+    }();
+
+    // Built only when referenced. Triangles are numbered as in the triangle
+    // list, before stripification.
+    static constexpr const MeshBvh& bvh =
+        CompileTimeMeshBvh<vertices, vertexElementCount, triangleIndices>
+            ::value;
+
+private:
+    template<auto& Stream, size_t Stride>
+    static constexpr auto encodeStream()
+    {
+        if constexpr (options.encodeStreams)
+        {
+            constexpr auto encodedSize =
+                StreamEncoding::getEncodedSize(Stream, Stride);
+
+            return StreamEncoding::encode<encodedSize>(Stream, Stride);
+        }
+        else
+        {
+            return std::array<std::uint8_t, 0>{};
+        }
+    }
+
+    static constexpr auto encodedVertices =
+        encodeStream<vertices, vertexElementCount>();
+
+    static constexpr auto encodedFaceIndices = encodeStream<faceIndices, 1>();
+
 public:
     static constexpr auto value =
-        MeshData
+    []
+    {
+        if constexpr (options.encodeStreams)
+        {
+            return
+                EncodedMeshData
+                {
+                    .vertices =
+                    {
+                        .bytes = encodedVertices,
+                        .wordCount = vertices.size(),
+                        .stride = vertexElementCount
+                    },
+                    .faceIndices =
+                    {
+                        .bytes = encodedFaceIndices,
+                        .wordCount = faceIndices.size(),
+                        .stride = 1
+                    },
+                    .materialChunks = materialChunks,
+                    .vertexAttributes = VertexType::attributes,
+                    .vertexStride = VertexType::stride
+                };
+        }
+        else
+        {
+            return
+                MeshData
+                {
+                    .vertices = vertices,
+                    .faceIndices = faceIndices,
+                    .materialChunks = materialChunks,
+                    .vertexAttributes = VertexType::attributes,
+                    .vertexStride = VertexType::stride
+                };
+        }
+    }();
+};
+
+template<>
+class RuntimeDeserialize<Mesh>
+{
+public:
+    using VertexType = Vertex<Position>;
+
+    RuntimeDeserialize(std::string_view contents)
+    {
+        const auto parsedObjectModels =
+            RuntimeParseWavefrontObj::parse(contents);
+
+        auto vertexCount = size_t{};
+        auto faceCount = size_t{};
+        auto useMaterialDirectivesCount = size_t{};
+        for (const auto& objectModel : parsedObjectModels.elements)
         {
-            .vertices = vertices,
-            .faceIndices = faceIndices,
-            .materialChunks = materialChunks,
-            .vertexAttributes = VertexType::attributes,
-            .vertexStride = VertexType::stride
-        };
+            const auto& [vertices, useMaterialDirectives] = objectModel.fields;
+
+            vertexCount += vertices.values.size();
+            useMaterialDirectivesCount += useMaterialDirectives.elements.size();
+
+            for (const auto& useMaterialDirective
+                : useMaterialDirectives.elements)
+            {
+                faceCount += std::get<0>(useMaterialDirective.fields)
+                    .values
+                    .size();
+            }
+        }
+
+        this->vertices.reserve(vertexCount * VertexType::elementCount);
+        this->faceIndices.reserve(faceCount * 3);
+        this->materialNames.reserve(useMaterialDirectivesCount);
+        this->materialChunks.reserve(useMaterialDirectivesCount);
+
+        for (const auto& objectModel : parsedObjectModels.elements)
+        {
+            const auto& [vertices, useMaterialDirectives] = objectModel.fields;
+
+            for (const auto& vertex : vertices.values)
+            {
+                const auto flattenedVertex =
+                    VertexType(Position({ vertex[0], vertex[1], vertex[2] }));
+
+                this->vertices.insert(
+                    this->vertices.end(),
+                    flattenedVertex.getData().begin(),
+                    flattenedVertex.getData().end());
+            }
+
+            for (const auto& useMaterialDirective
+                : useMaterialDirectives.elements)
+            {
+                const auto& faces = std::get<0>(useMaterialDirective.fields);
+
+                const auto offset = this->faceIndices.size();
+                for (const auto& face : faces.values)
+                {
+                    for (const auto vertexIndex : face)
+                    {
+                        this->faceIndices.push_back(vertexIndex - 1);
+                    }
+                }
+
+                const auto& name =
+                    this->materialNames.emplace_back(useMaterialDirective.id);
+
+                this->materialChunks.push_back({
+                    .name = name,
+                    .offset = offset,
+                    .count = this->faceIndices.size() - offset
+                });
+            }
+        }
+    }
+
+    RuntimeDeserialize(const RuntimeDeserialize&) = delete;
+    RuntimeDeserialize(RuntimeDeserialize&&) = delete;
+    RuntimeDeserialize& operator=(const RuntimeDeserialize&) = delete;
+
+    MeshData getValue() const
+    {
+        return
+            MeshData
+            {
+                .vertices = this->vertices,
+                .faceIndices = this->faceIndices,
+                .materialChunks = this->materialChunks,
+                .vertexAttributes = VertexType::attributes,
+                .vertexStride = VertexType::stride
+            };
+    }
+
+private:
+    std::vector<GLfloat> vertices;
+    std::vector<GLuint> faceIndices;
+    std::vector<std::string> materialNames;
+    std::vector<MeshData::MaterialChunk> materialChunks;
 };
 } // namespace ctoAssetsRTIS
@@ -0,0 +1,38 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+
+namespace ctoAssetsRTIS
+{
+struct MeshProcessingOptions
+{
+    bool encodeStreams = false;
+    bool removeHiddenGeometry = false;
+    bool stripifyTriangles = false;
+};
+
+template<typename StringProvider, MeshProcessingOptions Options>
+struct ProcessedWith
+{
+    static constexpr auto value = StringProvider::value;
+    static constexpr auto options = Options;
+};
+
+template<typename StringProvider>
+constexpr auto getMeshProcessingOptions()
+{
+    if constexpr (requires { StringProvider::options; })
+    {
+        return StringProvider::options;
+    }
+    else
+    {
+        return MeshProcessingOptions{};
+    }
+}
+} // namespace ctoAssetsRTIS
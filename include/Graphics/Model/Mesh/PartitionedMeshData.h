@@ -0,0 +1,771 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "MeshBvh.h"
+#include "MeshData.h"
+
+
+namespace ctoAssetsRTIS
+{
+struct MeshInstance
+{
+    std::array<float, 3> offset;
+    std::span<const MeshData::MaterialChunk> materialChunks;
+};
+
+struct PartitionedMeshData
+{
+    const MeshData meshData;
+    const std::span<const MeshInstance> instances;
+};
+
+// Splits a mesh into connected components and stores each distinct shape
+// once, centred on its bounding box. Components that match a shape up to
+// translation become instances of it. Shape triangles are ordered so that
+// each instance's materials form as few contiguous chunks as possible.
+template<typename StringProvider>
+class CompileTimeDeserialize<PartitionedMeshData, StringProvider>
+{
+private:
+    using Source = CompileTimeDeserialize<Mesh, StringProvider>;
+    using VertexType = typename Source::VertexType;
+
+    static_assert(
+        !Source::options.stripifyTriangles,
+        "Partitioning requires a triangle list");
+
+    static constexpr auto& sourceVertices = Source::vertices;
+    static constexpr auto& sourceFaceIndices = Source::faceIndices;
+    static constexpr auto& sourceMaterialChunks = Source::materialChunks;
+
+    static constexpr auto stride = VertexType::elementCount;
+    static constexpr auto vertexCount = sourceVertices.size() / stride;
+    static constexpr auto triangleCount = sourceFaceIndices.size() / 3;
+    static constexpr auto positionTolerance = 1e-4f;
+
+    struct Analysis
+    {
+        std::array<size_t, vertexCount> vertexComponents{};
+        std::array<size_t, vertexCount> componentVertices{};
+        std::array<size_t, vertexCount + 1> componentVertexOffsets{};
+        std::array<size_t, triangleCount> componentTriangles{};
+        std::array<size_t, vertexCount + 1> componentTriangleOffsets{};
+        std::array<std::array<float, 3>, vertexCount> componentMinima{};
+        std::array<size_t, vertexCount> componentShapes{};
+        size_t componentCount = 0;
+
+        std::array<size_t, vertexCount> shapeComponents{};
+        std::array<size_t, vertexCount + 1> shapeTriangleOffsets{};
+        size_t shapeCount = 0;
+
+        std::array<size_t, triangleCount> triangleMaterials{};
+        std::array<size_t, triangleCount> instanceMaterials{};
+
+        std::array<size_t, vertexCount> outputVertices{};
+        std::array<size_t, vertexCount> vertexOutputIndices{};
+        size_t outputVertexCount = 0;
+
+        std::array<size_t, triangleCount> outputTriangles{};
+        size_t outputTriangleCount = 0;
+
+        size_t materialChunkCount = 0;
+    };
+
+    static constexpr float getPosition(size_t vertex, size_t axis)
+    {
+        return sourceVertices[vertex * stride + axis];
+    }
+
+    static constexpr size_t getCorner(size_t triangle, size_t corner)
+    {
+        return sourceFaceIndices[triangle * 3 + corner];
+    }
+
+    static constexpr void findComponents(Analysis& analysis)
+    {
+        auto parents = std::array<size_t, vertexCount>{};
+        for (auto i = size_t{}; i < vertexCount; i++)
+        {
+            parents[i] = i;
+        }
+
+        const auto findRoot =
+        [&](size_t vertex)
+        {
+            while (parents[vertex] != vertex)
+            {
+                parents[vertex] = parents[parents[vertex]];
+                vertex = parents[vertex];
+            }
+
+            return vertex;
+        };
+
+        for (auto triangle = size_t{}; triangle < triangleCount; triangle++)
+        {
+            for (auto corner = size_t{ 1 }; corner < 3; corner++)
+            {
+                const auto first = findRoot(getCorner(triangle, 0));
+                const auto other = findRoot(getCorner(triangle, corner));
+                if (first != other)
+                {
+                    parents[other] = first;
+                }
+            }
+        }
+
+        auto rootComponents = std::array<size_t, vertexCount>{};
+        rootComponents.fill(vertexCount);
+        for (auto vertex = size_t{}; vertex < vertexCount; vertex++)
+        {
+            auto& component = rootComponents[findRoot(vertex)];
+            if (component == vertexCount)
+            {
+                component = analysis.componentCount++;
+            }
+
+            analysis.vertexComponents[vertex] = component;
+        }
+
+        const auto groupBy =
+        [&](auto& members, auto& offsets, size_t memberCount, auto getGroup)
+        {
+            for (auto member = size_t{}; member < memberCount; member++)
+            {
+                offsets[getGroup(member) + 1]++;
+            }
+
+            for (auto group = size_t{}; group < analysis.componentCount;
+                group++)
+            {
+                offsets[group + 1] += offsets[group];
+            }
+
+            auto cursors = offsets;
+            for (auto member = size_t{}; member < memberCount; member++)
+            {
+                members[cursors[getGroup(member)]++] = member;
+            }
+        };
+
+        groupBy(
+            analysis.componentVertices,
+            analysis.componentVertexOffsets,
+            vertexCount,
+            [&](size_t vertex) { return analysis.vertexComponents[vertex]; });
+
+        groupBy(
+            analysis.componentTriangles,
+            analysis.componentTriangleOffsets,
+            triangleCount,
+            [&](size_t triangle)
+            {
+                return analysis.vertexComponents[getCorner(triangle, 0)];
+            });
+
+        for (auto component = size_t{}; component < analysis.componentCount;
+            component++)
+        {
+            auto& minimum = analysis.componentMinima[component];
+            minimum =
+                {
+                    getPosition(
+                        analysis.componentVertices[
+                            analysis.componentVertexOffsets[component]],
+                        0),
+                    getPosition(
+                        analysis.componentVertices[
+                            analysis.componentVertexOffsets[component]],
+                        1),
+                    getPosition(
+                        analysis.componentVertices[
+                            analysis.componentVertexOffsets[component]],
+                        2)
+                };
+
+            for (auto i = analysis.componentVertexOffsets[component];
+                i < analysis.componentVertexOffsets[component + 1];
+                i++)
+            {
+                for (auto axis = size_t{}; axis < 3; axis++)
+                {
+                    minimum[axis] =
+                        std::min(
+                            minimum[axis],
+                            getPosition(analysis.componentVertices[i], axis));
+                }
+            }
+        }
+    }
+
+    static constexpr void findTriangleMaterials(Analysis& analysis)
+    {
+        for (auto chunk = size_t{}; chunk < sourceMaterialChunks.size();
+            chunk++)
+        {
+            auto material = chunk;
+            for (auto other = size_t{}; other < chunk; other++)
+            {
+                if (sourceMaterialChunks[other].name
+                    == sourceMaterialChunks[chunk].name)
+                {
+                    material = other;
+                    break;
+                }
+            }
+
+            const auto& materialChunk = sourceMaterialChunks[chunk];
+            for (auto triangle = materialChunk.offset / 3;
+                triangle < (materialChunk.offset + materialChunk.count) / 3;
+                triangle++)
+            {
+                analysis.triangleMaterials[triangle] = material;
+            }
+        }
+    }
+
+    // Records, for every triangle of the component, the material it has at
+    // the matching local triangle of the reference component.
+    static constexpr bool matchComponent(
+        Analysis& analysis,
+        size_t component,
+        size_t reference)
+    {
+        const auto vertexBegin = analysis.componentVertexOffsets[component];
+        const auto vertexEnd = analysis.componentVertexOffsets[component + 1];
+        const auto referenceVertexBegin =
+            analysis.componentVertexOffsets[reference];
+        const auto referenceVertexEnd =
+            analysis.componentVertexOffsets[reference + 1];
+
+        const auto triangleBegin =
+            analysis.componentTriangleOffsets[component];
+        const auto triangleEnd =
+            analysis.componentTriangleOffsets[component + 1];
+        const auto referenceTriangleBegin =
+            analysis.componentTriangleOffsets[reference];
+        const auto referenceTriangleEnd =
+            analysis.componentTriangleOffsets[reference + 1];
+
+        if (vertexEnd - vertexBegin != referenceVertexEnd - referenceVertexBegin
+            || triangleEnd - triangleBegin
+                != referenceTriangleEnd - referenceTriangleBegin)
+        {
+            return false;
+        }
+
+        const auto& minimum = analysis.componentMinima[component];
+        const auto& referenceMinimum = analysis.componentMinima[reference];
+
+        auto vertexMap = std::array<size_t, vertexCount>{};
+        for (auto i = vertexBegin; i < vertexEnd; i++)
+        {
+            const auto vertex = analysis.componentVertices[i];
+
+            auto found = false;
+            for (auto j = referenceVertexBegin; j < referenceVertexEnd; j++)
+            {
+                const auto referenceVertex = analysis.componentVertices[j];
+
+                auto matches = true;
+                for (auto axis = size_t{}; axis < 3 && matches; axis++)
+                {
+                    const auto difference =
+                        (getPosition(vertex, axis) - minimum[axis])
+                            - (getPosition(referenceVertex, axis)
+                                - referenceMinimum[axis]);
+
+                    matches =
+                        difference < positionTolerance
+                            && difference > -positionTolerance;
+                }
+
+                if (matches)
+                {
+                    vertexMap[vertex] = referenceVertex;
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found)
+            {
+                return false;
+            }
+        }
+
+        // Triangles the reference also has are matched directly. The rest
+        // must pair up into quads split along the other diagonal, and take
+        // the material of the quad they cover.
+        auto matched = std::array<bool, triangleCount>{};
+        auto unmatched = std::array<std::array<size_t, 3>, triangleCount>{};
+        auto unmatchedMaterials = std::array<size_t, triangleCount>{};
+        auto unmatchedCount = size_t{};
+
+        for (auto i = triangleBegin; i < triangleEnd; i++)
+        {
+            const auto triangle = analysis.componentTriangles[i];
+            const auto mapped =
+                std::array
+                {
+                    vertexMap[getCorner(triangle, 0)],
+                    vertexMap[getCorner(triangle, 1)],
+                    vertexMap[getCorner(triangle, 2)]
+                };
+
+            auto found = false;
+            for (auto j = referenceTriangleBegin; j < referenceTriangleEnd; j++)
+            {
+                const auto referenceTriangle = analysis.componentTriangles[j];
+                for (auto rotation = size_t{}; rotation < 3; rotation++)
+                {
+                    found =
+                        mapped[0] == getCorner(referenceTriangle, rotation)
+                        && mapped[1]
+                            == getCorner(referenceTriangle, (rotation + 1) % 3)
+                        && mapped[2]
+                            == getCorner(referenceTriangle, (rotation + 2) % 3);
+
+                    if (found)
+                    {
+                        break;
+                    }
+                }
+
+                if (found)
+                {
+                    const auto local = j - referenceTriangleBegin;
+                    matched[local] = true;
+                    analysis.instanceMaterials[triangleBegin + local] =
+                        analysis.triangleMaterials[triangle];
+                    break;
+                }
+            }
+
+            if (!found)
+            {
+                unmatched[unmatchedCount] = mapped;
+                unmatchedMaterials[unmatchedCount] =
+                    analysis.triangleMaterials[triangle];
+                unmatchedCount++;
+            }
+        }
+
+        const auto contains =
+        [](const auto& corners, size_t cornerCount, size_t vertex)
+        {
+            for (auto i = size_t{}; i < cornerCount; i++)
+            {
+                if (corners[i] == vertex)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        };
+
+        auto paired = std::array<bool, triangleCount>{};
+        for (auto first = size_t{}; first < unmatchedCount; first++)
+        {
+            if (paired[first])
+            {
+                continue;
+            }
+
+            auto quad = std::array<size_t, 4>{};
+            auto second = first + 1;
+            for (; second < unmatchedCount; second++)
+            {
+                auto sharedCount = size_t{};
+                for (const auto vertex : unmatched[second])
+                {
+                    if (contains(unmatched[first], 3, vertex))
+                    {
+                        sharedCount++;
+                    }
+                    else
+                    {
+                        quad[3] = vertex;
+                    }
+                }
+
+                if (!paired[second]
+                    && sharedCount == 2
+                    && unmatchedMaterials[second]
+                        == unmatchedMaterials[first])
+                {
+                    break;
+                }
+            }
+
+            if (second == unmatchedCount)
+            {
+                return false;
+            }
+
+            paired[first] = true;
+            paired[second] = true;
+            std::copy_n(unmatched[first].begin(), 3, quad.begin());
+
+            auto coveredCount = size_t{};
+            for (auto j = referenceTriangleBegin; j < referenceTriangleEnd; j++)
+            {
+                const auto local = j - referenceTriangleBegin;
+                const auto referenceTriangle = analysis.componentTriangles[j];
+                if (!matched[local]
+                    && contains(quad, 4, getCorner(referenceTriangle, 0))
+                    && contains(quad, 4, getCorner(referenceTriangle, 1))
+                    && contains(quad, 4, getCorner(referenceTriangle, 2)))
+                {
+                    matched[local] = true;
+                    analysis.instanceMaterials[triangleBegin + local] =
+                        unmatchedMaterials[first];
+                    coveredCount++;
+                }
+            }
+
+            if (coveredCount != 2)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static constexpr void findShapes(Analysis& analysis)
+    {
+        for (auto component = size_t{}; component < analysis.componentCount;
+            component++)
+        {
+            auto shape = size_t{};
+            while (shape < analysis.shapeCount
+                && !matchComponent(
+                    analysis,
+                    component,
+                    analysis.shapeComponents[shape]))
+            {
+                shape++;
+            }
+
+            if (shape == analysis.shapeCount)
+            {
+                analysis.shapeComponents[analysis.shapeCount++] = component;
+                matchComponent(analysis, component, component);
+            }
+
+            analysis.componentShapes[component] = shape;
+        }
+    }
+
+    static constexpr void layOutShapes(Analysis& analysis)
+    {
+        for (auto shape = size_t{}; shape < analysis.shapeCount; shape++)
+        {
+            const auto reference = analysis.shapeComponents[shape];
+
+            for (auto i = analysis.componentVertexOffsets[reference];
+                i < analysis.componentVertexOffsets[reference + 1];
+                i++)
+            {
+                const auto vertex = analysis.componentVertices[i];
+                analysis.vertexOutputIndices[vertex] =
+                    analysis.outputVertexCount;
+                analysis.outputVertices[analysis.outputVertexCount++] = vertex;
+            }
+
+            const auto referenceTriangleBegin =
+                analysis.componentTriangleOffsets[reference];
+            const auto localTriangleCount =
+                analysis.componentTriangleOffsets[reference + 1]
+                    - referenceTriangleBegin;
+
+            const auto compareMaterials =
+            [&](size_t left, size_t right)
+            {
+                for (auto component = size_t{};
+                    component < analysis.componentCount;
+                    component++)
+                {
+                    if (analysis.componentShapes[component] != shape)
+                    {
+                        continue;
+                    }
+
+                    const auto offset =
+                        analysis.componentTriangleOffsets[component];
+                    const auto leftMaterial =
+                        analysis.instanceMaterials[offset + left];
+                    const auto rightMaterial =
+                        analysis.instanceMaterials[offset + right];
+
+                    if (leftMaterial != rightMaterial)
+                    {
+                        return leftMaterial < rightMaterial;
+                    }
+                }
+
+                return false;
+            };
+
+            const auto first = analysis.outputTriangleCount;
+            for (auto local = size_t{}; local < localTriangleCount; local++)
+            {
+                auto position = first + local;
+                while (position > first
+                    && compareMaterials(
+                        local,
+                        analysis.outputTriangles[position - 1]))
+                {
+                    analysis.outputTriangles[position] =
+                        analysis.outputTriangles[position - 1];
+                    position--;
+                }
+
+                analysis.outputTriangles[position] = local;
+            }
+
+            analysis.outputTriangleCount += localTriangleCount;
+            analysis.shapeTriangleOffsets[shape + 1] =
+                analysis.outputTriangleCount;
+        }
+    }
+
+    template<typename Visitor>
+    static constexpr void visitMaterialChunks(
+        const Analysis& analysis,
+        Visitor visit)
+    {
+        for (auto component = size_t{}; component < analysis.componentCount;
+            component++)
+        {
+            const auto shape = analysis.componentShapes[component];
+            const auto offset = analysis.componentTriangleOffsets[component];
+
+            auto chunkBegin = analysis.shapeTriangleOffsets[shape];
+            const auto shapeEnd = analysis.shapeTriangleOffsets[shape + 1];
+            for (auto position = chunkBegin; position < shapeEnd; position++)
+            {
+                const auto material =
+                    analysis.instanceMaterials[
+                        offset + analysis.outputTriangles[position]];
+
+                const auto nextPosition = position + 1;
+                if (nextPosition == shapeEnd
+                    || analysis.instanceMaterials[
+                        offset + analysis.outputTriangles[nextPosition]]
+                            != material)
+                {
+                    visit(component, material, chunkBegin, nextPosition);
+                    chunkBegin = nextPosition;
+                }
+            }
+        }
+    }
+
+    static constexpr auto analysis =
+    []
+    {
+        auto result = Analysis{};
+
+        findComponents(result);
+        findTriangleMaterials(result);
+        findShapes(result);
+        layOutShapes(result);
+
+        visitMaterialChunks(
+            result,
+            [&](size_t, size_t, size_t, size_t)
+            {
+                result.materialChunkCount++;
+            });
+
+        return result;
+    }();
+
+    static constexpr auto getHalfExtent(size_t shape)
+    {
+        const auto reference = analysis.shapeComponents[shape];
+        const auto& minimum = analysis.componentMinima[reference];
+
+        auto halfExtent = std::array<float, 3>{};
+        for (auto i = analysis.componentVertexOffsets[reference];
+            i < analysis.componentVertexOffsets[reference + 1];
+            i++)
+        {
+            for (auto axis = size_t{}; axis < 3; axis++)
+            {
+                halfExtent[axis] =
+                    std::max(
+                        halfExtent[axis],
+                        (getPosition(analysis.componentVertices[i], axis)
+                            - minimum[axis]) / 2.0f);
+            }
+        }
+
+        return halfExtent;
+    }
+
+public:
+    static constexpr auto vertices =
+    []
+    {
+        auto result =
+            std::array<GLfloat, analysis.outputVertexCount * stride>{};
+
+        for (auto i = size_t{}; i < analysis.outputVertexCount; i++)
+        {
+            const auto vertex = analysis.outputVertices[i];
+            const auto component = analysis.vertexComponents[vertex];
+            const auto halfExtent =
+                getHalfExtent(analysis.componentShapes[component]);
+
+            for (auto element = size_t{}; element < stride; element++)
+            {
+                result[i * stride + element] =
+                    sourceVertices[vertex * stride + element];
+            }
+
+            for (auto axis = size_t{}; axis < 3; axis++)
+            {
+                result[i * stride + axis] -=
+                    analysis.componentMinima[component][axis]
+                        + halfExtent[axis];
+            }
+        }
+
+        return result;
+    }();
+
+    static constexpr auto faceIndices =
+    []
+    {
+        auto result =
+            std::array<GLuint, analysis.outputTriangleCount * 3>{};
+
+        for (auto shape = size_t{}; shape < analysis.shapeCount; shape++)
+        {
+            const auto reference = analysis.shapeComponents[shape];
+            const auto referenceTriangleBegin =
+                analysis.componentTriangleOffsets[reference];
+
+            for (auto position = analysis.shapeTriangleOffsets[shape];
+                position < analysis.shapeTriangleOffsets[shape + 1];
+                position++)
+            {
+                const auto triangle =
+                    analysis.componentTriangles[
+                        referenceTriangleBegin
+                            + analysis.outputTriangles[position]];
+
+                for (auto corner = size_t{}; corner < 3; corner++)
+                {
+                    result[position * 3 + corner] =
+                        static_cast<GLuint>(
+                            analysis.vertexOutputIndices[
+                                getCorner(triangle, corner)]);
+                }
+            }
+        }
+
+        return result;
+    }();
+
+    static constexpr auto materialChunks =
+    []
+    {
+        auto result =
+            std::array<MeshData::MaterialChunk, analysis.materialChunkCount>{};
+
+        auto offset = size_t{};
+        visitMaterialChunks(
+            analysis,
+            [&](size_t, size_t material, size_t begin, size_t end)
+            {
+                result[offset++] =
+                    MeshData::MaterialChunk
+                    {
+                        .name = sourceMaterialChunks[material].name,
+                        .offset = begin * 3,
+                        .count = (end - begin) * 3
+                    };
+            });
+
+        return result;
+    }();
+
+    static constexpr auto instances =
+    []
+    {
+        auto chunkOffsets =
+            std::array<size_t, analysis.componentCount + 1>{};
+        visitMaterialChunks(
+            analysis,
+            [&](size_t component, size_t, size_t, size_t)
+            {
+                chunkOffsets[component + 1]++;
+            });
+
+        auto result =
+            std::array<MeshInstance, analysis.componentCount>{};
+
+        for (auto component = size_t{}; component < analysis.componentCount;
+            component++)
+        {
+            chunkOffsets[component + 1] += chunkOffsets[component];
+
+            const auto halfExtent =
+                getHalfExtent(analysis.componentShapes[component]);
+            const auto& minimum = analysis.componentMinima[component];
+
+            result[component] =
+                MeshInstance
+                {
+                    .offset =
+                    {
+                        minimum[0] + halfExtent[0],
+                        minimum[1] + halfExtent[1],
+                        minimum[2] + halfExtent[2]
+                    },
+                    .materialChunks =
+                        std::span(materialChunks).subspan(
+                            chunkOffsets[component],
+                            chunkOffsets[component + 1]
+                                - chunkOffsets[component])
+                };
+        }
+
+        return result;
+    }();
+
+    static constexpr auto value =
+        PartitionedMeshData
+        {
+            .meshData =
+            {
+                .vertices = vertices,
+                .faceIndices = faceIndices,
+                .materialChunks = {},
+                .vertexAttributes = VertexType::attributes,
+                .vertexStride = VertexType::stride
+            },
+            .instances = instances
+        };
+
+    // Built only when referenced, over the shared shape, so it is queried in
+    // instance-local space.
+    static constexpr const MeshBvh& bvh =
+        CompileTimeMeshBvh<vertices, stride, faceIndices>::value;
+};
+} // namespace ctoAssetsRTIS
@@ -0,0 +1,489 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+
+
+namespace ctoAssetsRTIS
+{
+// Interior nodes have count 0 and their two children at offset and
+// offset + 1. Leaves cover count entries of the triangle order from offset.
+struct BvhNode
+{
+    std::array<float, 3> minimum;
+    std::array<float, 3> maximum;
+    std::uint32_t offset;
+    std::uint32_t count;
+};
+
+// Bounding volume hierarchy over the triangles of an indexed mesh, buildable
+// in constant expressions.
+template<size_t TriangleCount>
+class TriangleBvh
+{
+public:
+    using Vector = std::array<float, 3>;
+
+    static constexpr auto leafSize = size_t{ 4 };
+    static constexpr auto binCount = size_t{ 12 };
+    static constexpr auto stackSize = size_t{ 64 };
+    static constexpr auto edgeTolerance = 1e-4f;
+
+    struct Ray
+    {
+        Vector origin;
+        Vector direction;
+        float minimumDistance = 0.0f;
+        float maximumDistance = std::numeric_limits<float>::infinity();
+    };
+
+    constexpr TriangleBvh(
+        std::span<const float> vertices,
+        size_t vertexStride,
+        std::span<const unsigned int> faceIndices)
+    {
+        for (auto triangle = size_t{}; triangle < TriangleCount; triangle++)
+        {
+            for (auto corner = size_t{}; corner < 3; corner++)
+            {
+                const auto vertex = faceIndices[triangle * 3 + corner];
+                for (auto axis = size_t{}; axis < 3; axis++)
+                {
+                    this->corners[triangle][corner][axis] =
+                        vertices[vertex * vertexStride + axis];
+                }
+            }
+
+            this->triangles[triangle] = static_cast<std::uint32_t>(triangle);
+        }
+
+        this->build();
+    }
+
+    // True if any triangle other than skippedTriangle crosses the ray within
+    // its distance range. Distances are in units of the direction's length.
+    constexpr bool intersectsAny(
+        const Ray& ray,
+        size_t skippedTriangle = TriangleCount) const
+    {
+        auto pendingNodes = std::array<size_t, stackSize>{};
+        auto pendingCount = size_t{};
+        pendingNodes[pendingCount++] = 0;
+
+        while (pendingCount > 0)
+        {
+            const auto& node = this->nodes[pendingNodes[--pendingCount]];
+            if (!intersectsBox(ray, node))
+            {
+                continue;
+            }
+
+            if (node.count == 0)
+            {
+                pendingNodes[pendingCount++] = node.offset + 1;
+                pendingNodes[pendingCount++] = node.offset;
+                continue;
+            }
+
+            for (auto i = node.offset; i < node.offset + node.count; i++)
+            {
+                const auto triangle = this->triangles[i];
+                if (triangle != skippedTriangle
+                    && intersectsTriangle(ray, this->corners[triangle]))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    constexpr const std::array<Vector, 3>& getCorners(size_t triangle) const
+    {
+        return this->corners[triangle];
+    }
+
+    constexpr const BvhNode& getRoot() const
+    {
+        return this->nodes[0];
+    }
+
+    constexpr size_t getNodeCount() const
+    {
+        return this->nodeCount;
+    }
+
+    constexpr size_t getDepth() const
+    {
+        return this->depth;
+    }
+
+    template<size_t NodeCount>
+    constexpr auto getNodes() const
+    {
+        auto result = std::array<BvhNode, NodeCount>{};
+        std::copy_n(this->nodes.begin(), NodeCount, result.begin());
+
+        return result;
+    }
+
+    constexpr const auto& getTriangleOrder() const
+    {
+        return this->triangles;
+    }
+
+private:
+    static constexpr Vector subtract(const Vector& left, const Vector& right)
+    {
+        return
+            {
+                left[0] - right[0],
+                left[1] - right[1],
+                left[2] - right[2]
+            };
+    }
+
+    static constexpr Vector cross(const Vector& left, const Vector& right)
+    {
+        return
+            {
+                left[1] * right[2] - left[2] * right[1],
+                left[2] * right[0] - left[0] * right[2],
+                left[0] * right[1] - left[1] * right[0]
+            };
+    }
+
+    static constexpr float dot(const Vector& left, const Vector& right)
+    {
+        return left[0] * right[0] + left[1] * right[1] + left[2] * right[2];
+    }
+
+    // Slab test. Axis-parallel components are handled without dividing by
+    // zero, which constant expressions reject.
+    static constexpr bool intersectsBox(const Ray& ray, const BvhNode& node)
+    {
+        auto nearDistance = ray.minimumDistance;
+        auto farDistance = ray.maximumDistance;
+
+        for (auto axis = size_t{}; axis < 3; axis++)
+        {
+            const auto origin = ray.origin[axis];
+            const auto direction = ray.direction[axis];
+
+            if (direction == 0.0f)
+            {
+                if (origin < node.minimum[axis] || origin > node.maximum[axis])
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            auto entry = (node.minimum[axis] - origin) / direction;
+            auto exit = (node.maximum[axis] - origin) / direction;
+            if (entry > exit)
+            {
+                std::swap(entry, exit);
+            }
+
+            nearDistance = std::max(nearDistance, entry);
+            farDistance = std::min(farDistance, exit);
+            if (nearDistance > farDistance)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Möller–Trumbore. Hits within edgeTolerance of an edge count, so rays
+    // cannot slip between triangles that share it.
+    static constexpr bool intersectsTriangle(
+        const Ray& ray,
+        const std::array<Vector, 3>& triangle)
+    {
+        const auto edge1 = subtract(triangle[1], triangle[0]);
+        const auto edge2 = subtract(triangle[2], triangle[0]);
+
+        const auto p = cross(ray.direction, edge2);
+        const auto determinant = dot(edge1, p);
+        if (determinant > -1e-12f && determinant < 1e-12f)
+        {
+            return false;
+        }
+
+        const auto inverseDeterminant = 1.0f / determinant;
+        const auto s = subtract(ray.origin, triangle[0]);
+
+        const auto u = dot(s, p) * inverseDeterminant;
+        if (u < -edgeTolerance || u > 1.0f + edgeTolerance)
+        {
+            return false;
+        }
+
+        const auto q = cross(s, edge1);
+        const auto v = dot(ray.direction, q) * inverseDeterminant;
+        if (v < -edgeTolerance || u + v > 1.0f + edgeTolerance)
+        {
+            return false;
+        }
+
+        const auto distance = dot(edge2, q) * inverseDeterminant;
+
+        return
+            distance > ray.minimumDistance
+                && distance < ray.maximumDistance;
+    }
+
+    constexpr Vector getCentroid(size_t triangle) const
+    {
+        const auto& triangleCorners = this->corners[triangle];
+
+        auto centroid = Vector{};
+        for (auto axis = size_t{}; axis < 3; axis++)
+        {
+            centroid[axis] =
+                (triangleCorners[0][axis]
+                    + triangleCorners[1][axis]
+                    + triangleCorners[2][axis]) / 3.0f;
+        }
+
+        return centroid;
+    }
+
+    static constexpr float getHalfArea(
+        const Vector& minimum,
+        const Vector& maximum)
+    {
+        const auto extent = subtract(maximum, minimum);
+
+        return
+            extent[0] * extent[1] + extent[1] * extent[2]
+                + extent[2] * extent[0];
+    }
+
+    static constexpr void expand(
+        Vector& minimum,
+        Vector& maximum,
+        const Vector& point)
+    {
+        for (auto axis = size_t{}; axis < 3; axis++)
+        {
+            minimum[axis] = std::min(minimum[axis], point[axis]);
+            maximum[axis] = std::max(maximum[axis], point[axis]);
+        }
+    }
+
+    // Splits nodes larger than leafSize at the centroid bin boundary with the
+    // lowest surface area heuristic cost over all three axes.
+    constexpr void build()
+    {
+        struct PendingNode
+        {
+            size_t node;
+            size_t first;
+            size_t count;
+            size_t depth;
+        };
+
+        struct Bin
+        {
+            Vector minimum;
+            Vector maximum;
+            size_t count;
+        };
+
+        constexpr auto infinity = std::numeric_limits<float>::infinity();
+        constexpr auto emptyBin =
+            Bin
+            {
+                .minimum = { infinity, infinity, infinity },
+                .maximum = { -infinity, -infinity, -infinity },
+                .count = 0
+            };
+
+        const auto addBin =
+        [](Bin& bounds, const Bin& bin)
+        {
+            if (bin.count > 0)
+            {
+                expand(bounds.minimum, bounds.maximum, bin.minimum);
+                expand(bounds.minimum, bounds.maximum, bin.maximum);
+                bounds.count += bin.count;
+            }
+        };
+
+        auto pendingNodes = std::array<PendingNode, stackSize>{};
+        auto pendingCount = size_t{};
+        pendingNodes[pendingCount++] =
+            {
+                .node = this->nodeCount++,
+                .first = 0,
+                .count = TriangleCount,
+                .depth = 1
+            };
+
+        while (pendingCount > 0)
+        {
+            const auto [nodeIndex, first, count, depth] =
+                pendingNodes[--pendingCount];
+            auto& node = this->nodes[nodeIndex];
+            this->depth = std::max(this->depth, depth);
+
+            auto centroidMinimum = getCentroid(this->triangles[first]);
+            auto centroidMaximum = centroidMinimum;
+
+            node.minimum = this->corners[this->triangles[first]][0];
+            node.maximum = node.minimum;
+            for (auto i = first; i < first + count; i++)
+            {
+                expand(
+                    centroidMinimum,
+                    centroidMaximum,
+                    getCentroid(this->triangles[i]));
+
+                for (const auto& corner : this->corners[this->triangles[i]])
+                {
+                    expand(node.minimum, node.maximum, corner);
+                }
+            }
+
+            node.offset = static_cast<std::uint32_t>(first);
+            node.count = static_cast<std::uint32_t>(count);
+            if (count <= leafSize)
+            {
+                continue;
+            }
+
+            const auto getBin =
+            [&](std::uint32_t triangle, size_t axis)
+            {
+                const auto bin =
+                    static_cast<size_t>(
+                        (getCentroid(triangle)[axis] - centroidMinimum[axis])
+                            * binCount
+                            / (centroidMaximum[axis] - centroidMinimum[axis]));
+
+                return std::min(bin, binCount - 1);
+            };
+
+            auto bestCost = infinity;
+            auto bestAxis = size_t{};
+            auto bestSplit = size_t{};
+            for (auto axis = size_t{}; axis < 3; axis++)
+            {
+                if (centroidMaximum[axis] == centroidMinimum[axis])
+                {
+                    continue;
+                }
+
+                auto bins = std::array<Bin, binCount>{};
+                bins.fill(emptyBin);
+                for (auto i = first; i < first + count; i++)
+                {
+                    auto& bin = bins[getBin(this->triangles[i], axis)];
+                    bin.count++;
+                    for (const auto& corner
+                        : this->corners[this->triangles[i]])
+                    {
+                        expand(bin.minimum, bin.maximum, corner);
+                    }
+                }
+
+                // Costs of the bins below each boundary, accumulated upward,
+                // then combined with the bins above it on the way down.
+                auto lowerCosts = std::array<float, binCount>{};
+                auto lower = emptyBin;
+                for (auto split = size_t{ 1 }; split < binCount; split++)
+                {
+                    addBin(lower, bins[split - 1]);
+                    lowerCosts[split] =
+                        lower.count == 0
+                            ? infinity
+                            : getHalfArea(lower.minimum, lower.maximum)
+                                * static_cast<float>(lower.count);
+                }
+
+                auto upper = emptyBin;
+                for (auto split = binCount - 1; split > 0; split--)
+                {
+                    addBin(upper, bins[split]);
+                    if (upper.count == 0 || upper.count == count)
+                    {
+                        continue;
+                    }
+
+                    const auto cost =
+                        lowerCosts[split]
+                            + getHalfArea(upper.minimum, upper.maximum)
+                                * static_cast<float>(upper.count);
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = split;
+                    }
+                }
+            }
+
+            // Every centroid coincides.
+            if (bestCost == infinity)
+            {
+                continue;
+            }
+
+            const auto middle =
+                std::partition(
+                    this->triangles.begin() + first,
+                    this->triangles.begin() + first + count,
+                    [&](std::uint32_t triangle)
+                    {
+                        return getBin(triangle, bestAxis) < bestSplit;
+                    });
+            const auto lowerCount =
+                static_cast<size_t>(
+                    middle - (this->triangles.begin() + first));
+
+            const auto firstChild = this->nodeCount;
+            this->nodeCount += 2;
+            node.offset = static_cast<std::uint32_t>(firstChild);
+            node.count = 0;
+
+            pendingNodes[pendingCount++] =
+                {
+                    .node = firstChild + 1,
+                    .first = first + lowerCount,
+                    .count = count - lowerCount,
+                    .depth = depth + 1
+                };
+            pendingNodes[pendingCount++] =
+                {
+                    .node = firstChild,
+                    .first = first,
+                    .count = lowerCount,
+                    .depth = depth + 1
+                };
+        }
+    }
+
+    std::array<std::array<Vector, 3>, TriangleCount> corners{};
+    std::array<std::uint32_t, TriangleCount> triangles{};
+    std::array<BvhNode, 2 * TriangleCount> nodes{};
+    size_t nodeCount = 0;
+    size_t depth = 0;
+};
+} // namespace ctoAssetsRTIS
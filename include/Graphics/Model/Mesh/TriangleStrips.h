@@ -0,0 +1,379 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+
+#include <GL/glew.h>
+
+
+namespace ctoAssetsRTIS
+{
+// Rewrites each material chunk of a triangle list as triangle strips joined
+// by restart indices. Strips are grown greedily across shared edges from the
+// triangle with the fewest free neighbors, and only while the strip's
+// alternating winding reproduces the original triangle. Chunks for which
+// strips would not save indices stay triangle lists.
+class TriangleStrips
+{
+public:
+    static constexpr auto restartIndex = std::numeric_limits<GLuint>::max();
+
+    template<typename MaterialChunk, size_t IndexCount, size_t ChunkCount>
+    struct Result
+    {
+        std::array<GLuint, IndexCount> indices;
+        size_t indexCount;
+        std::array<MaterialChunk, ChunkCount> materialChunks;
+    };
+
+    template<typename MaterialChunk, size_t IndexCount, size_t ChunkCount>
+    static constexpr auto stripify(
+        const std::array<GLuint, IndexCount>& faceIndices,
+        const std::array<MaterialChunk, ChunkCount>& materialChunks)
+    {
+        constexpr auto triangleCount = IndexCount / 3;
+
+        const auto neighbors =
+            findNeighbors<triangleCount>(faceIndices, materialChunks);
+
+        auto result =
+            Result<MaterialChunk, IndexCount, ChunkCount>
+            {
+                .indices = {},
+                .indexCount = 0,
+                .materialChunks = materialChunks
+            };
+
+        auto visited = std::array<bool, triangleCount>{};
+        auto trialStamps = std::array<size_t, triangleCount>{};
+        auto stamp = size_t{};
+
+        const auto isFree =
+        [&](size_t triangle)
+        {
+            return
+                triangle != noNeighbor
+                    && !visited[triangle]
+                    && trialStamps[triangle] != stamp;
+        };
+
+        // Grows a strip from the given rotation of a triangle, calling emit
+        // for each vertex and claim for each triangle added.
+        const auto growStrip =
+        [&](size_t first, size_t rotation, auto emit, auto claim)
+        {
+            auto strip = std::array<GLuint, 3>{};
+            for (auto corner = size_t{}; corner < 3; corner++)
+            {
+                strip[corner] =
+                    faceIndices[first * 3 + (rotation + corner) % 3];
+                emit(strip[corner]);
+            }
+            claim(first);
+
+            auto length = size_t{ 1 };
+            auto current = first;
+            while (true)
+            {
+                const auto previous = strip[1];
+                const auto last = strip[2];
+
+                auto next = noNeighbor;
+                for (auto edge = size_t{}; edge < 3; edge++)
+                {
+                    const auto from = faceIndices[current * 3 + edge];
+                    const auto to = faceIndices[current * 3 + (edge + 1) % 3];
+                    if (((from == previous && to == last)
+                            || (from == last && to == previous))
+                        && isFree(neighbors[current][edge]))
+                    {
+                        next = neighbors[current][edge];
+                    }
+                }
+
+                if (next == noNeighbor)
+                {
+                    return length;
+                }
+
+                auto added = GLuint{};
+                for (auto corner = size_t{}; corner < 3; corner++)
+                {
+                    const auto vertex = faceIndices[next * 3 + corner];
+                    if (vertex != previous && vertex != last)
+                    {
+                        added = vertex;
+                    }
+                }
+
+                const auto rendered =
+                    length % 2 == 0
+                        ? std::array{ previous, last, added }
+                        : std::array{ last, previous, added };
+
+                if (!isRotationOf(rendered, faceIndices, next))
+                {
+                    return length;
+                }
+
+                strip = { previous, last, added };
+                emit(added);
+                claim(next);
+
+                current = next;
+                length++;
+            }
+        };
+
+        auto chunkIndices = std::array<GLuint, IndexCount + triangleCount>{};
+        for (auto& materialChunk : result.materialChunks)
+        {
+            const auto firstTriangle = materialChunk.offset / 3;
+            const auto endTriangle =
+                firstTriangle + materialChunk.count / 3;
+
+            auto chunkIndexCount = size_t{};
+            while (true)
+            {
+                auto first = noNeighbor;
+                auto fewestFreeNeighbors = size_t{ 4 };
+                for (auto triangle = firstTriangle; triangle < endTriangle;
+                    triangle++)
+                {
+                    if (visited[triangle])
+                    {
+                        continue;
+                    }
+
+                    const auto freeNeighbors =
+                        static_cast<size_t>(
+                            std::count_if(
+                                neighbors[triangle].begin(),
+                                neighbors[triangle].end(),
+                                isFree));
+
+                    if (freeNeighbors < fewestFreeNeighbors)
+                    {
+                        first = triangle;
+                        fewestFreeNeighbors = freeNeighbors;
+                    }
+                }
+
+                if (first == noNeighbor)
+                {
+                    break;
+                }
+
+                auto bestRotation = size_t{};
+                auto bestLength = size_t{};
+                for (auto rotation = size_t{}; rotation < 3; rotation++)
+                {
+                    stamp++;
+                    const auto length =
+                        growStrip(
+                            first,
+                            rotation,
+                            [](GLuint) {},
+                            [&](size_t triangle)
+                            {
+                                trialStamps[triangle] = stamp;
+                            });
+
+                    if (length > bestLength)
+                    {
+                        bestRotation = rotation;
+                        bestLength = length;
+                    }
+                }
+
+                if (chunkIndexCount > 0)
+                {
+                    chunkIndices[chunkIndexCount++] = restartIndex;
+                }
+
+                stamp++;
+                growStrip(
+                    first,
+                    bestRotation,
+                    [&](GLuint vertex)
+                    {
+                        chunkIndices[chunkIndexCount++] = vertex;
+                    },
+                    [&](size_t triangle)
+                    {
+                        visited[triangle] = true;
+                    });
+            }
+
+            const auto stripped = chunkIndexCount < materialChunk.count;
+            const auto* chunkBegin =
+                stripped
+                    ? chunkIndices.data()
+                    : faceIndices.data() + materialChunk.offset;
+            const auto count = stripped ? chunkIndexCount : materialChunk.count;
+
+            std::copy_n(
+                chunkBegin,
+                count,
+                result.indices.begin() + result.indexCount);
+
+            materialChunk.offset = result.indexCount;
+            materialChunk.count = count;
+            materialChunk.primitiveMode =
+                stripped ? GLenum{ GL_TRIANGLE_STRIP } : GLenum{ GL_TRIANGLES };
+
+            result.indexCount += count;
+        }
+
+        return result;
+    }
+
+    template<size_t Size, size_t IndexCount>
+    static constexpr auto truncate(
+        const std::array<GLuint, IndexCount>& indices)
+    {
+        auto result = std::array<GLuint, Size>{};
+        std::copy_n(indices.begin(), Size, result.begin());
+
+        return result;
+    }
+
+private:
+    static constexpr auto noNeighbor = std::numeric_limits<size_t>::max();
+
+    static constexpr bool isRotationOf(
+        const std::array<GLuint, 3>& corners,
+        const auto& faceIndices,
+        size_t triangle)
+    {
+        for (auto rotation = size_t{}; rotation < 3; rotation++)
+        {
+            auto matches = true;
+            for (auto corner = size_t{}; corner < 3; corner++)
+            {
+                matches =
+                    matches
+                        && corners[corner]
+                            == faceIndices[
+                                triangle * 3 + (rotation + corner) % 3];
+            }
+
+            if (matches)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Triangles are neighbors across an edge when they are the only two in
+    // their material chunk to use it.
+    template<
+        size_t TriangleCount,
+        size_t IndexCount,
+        typename MaterialChunk,
+        size_t ChunkCount>
+    static constexpr auto findNeighbors(
+        const std::array<GLuint, IndexCount>& faceIndices,
+        const std::array<MaterialChunk, ChunkCount>& materialChunks)
+    {
+        struct Edge
+        {
+            size_t chunk;
+            GLuint low;
+            GLuint high;
+            size_t triangle;
+            size_t edge;
+
+            constexpr bool isSameAs(const Edge& other) const
+            {
+                return
+                    this->chunk == other.chunk
+                        && this->low == other.low
+                        && this->high == other.high;
+            }
+        };
+
+        auto edges = std::array<Edge, IndexCount>{};
+        edges.fill({ .chunk = ChunkCount });
+
+        for (auto chunk = size_t{}; chunk < ChunkCount; chunk++)
+        {
+            const auto& materialChunk = materialChunks[chunk];
+            for (auto i = materialChunk.offset;
+                i < materialChunk.offset + materialChunk.count;
+                i++)
+            {
+                const auto triangle = i / 3;
+                const auto edge = i % 3;
+                const auto from = faceIndices[i];
+                const auto to = faceIndices[triangle * 3 + (edge + 1) % 3];
+
+                edges[i] =
+                    Edge
+                    {
+                        .chunk = chunk,
+                        .low = std::min(from, to),
+                        .high = std::max(from, to),
+                        .triangle = triangle,
+                        .edge = edge
+                    };
+            }
+        }
+
+        std::sort(
+            edges.begin(),
+            edges.end(),
+            [](const Edge& left, const Edge& right)
+            {
+                if (left.chunk != right.chunk)
+                {
+                    return left.chunk < right.chunk;
+                }
+
+                if (left.low != right.low)
+                {
+                    return left.low < right.low;
+                }
+
+                return left.high < right.high;
+            });
+
+        auto result = std::array<std::array<size_t, 3>, TriangleCount>{};
+        for (auto& triangleNeighbors : result)
+        {
+            triangleNeighbors.fill(noNeighbor);
+        }
+
+        for (auto i = size_t{}; i < IndexCount;)
+        {
+            auto end = i + 1;
+            while (end < IndexCount && edges[end].isSameAs(edges[i]))
+            {
+                end++;
+            }
+
+            if (end - i == 2 && edges[i].chunk != ChunkCount)
+            {
+                result[edges[i].triangle][edges[i].edge] =
+                    edges[i + 1].triangle;
+                result[edges[i + 1].triangle][edges[i + 1].edge] =
+                    edges[i].triangle;
+            }
+
+            i = end;
+        }
+
+        return result;
+    }
+};
+} // namespace ctoAssetsRTIS
@@ -0,0 +1,116 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Graphics/Model/Model.h"
+#include "Memory/FrameArena.h"
+#include "Simulation/DynamicAabbTree.h"
+#include "Simulation/Scene.h"
+
+
+namespace ctoAssetsRTIS
+{
+// Everything needed to draw one frame, captured from the scene once the
+// frame is simulated, so drawing it needs nothing the simulation may be
+// changing. Models are referenced rather than copied and must outlive the
+// packet.
+struct FramePacket
+{
+    struct Draw
+    {
+        const Model* model;
+        std::span<const MeshData::MaterialChunk> materialChunks = {};
+        glm::mat4 modelMatrix = glm::mat4(1.0f);
+    };
+
+    // The earliest input the frame applied, for InputLatencyTracker.
+    struct LatencySample
+    {
+        double inputTimestamp;
+        double updateTimestamp;
+    };
+
+    glm::mat4 viewMatrix = glm::mat4(1.0f);
+    glm::mat4 projectionMatrix = glm::mat4(1.0f);
+    // Valid until the next capture.
+    std::span<const Draw> draws;
+    std::optional<LatencySample> latencySample;
+
+    struct CaptureArguments
+    {
+        const Scene& scene;
+        const glm::mat4& viewMatrix;
+        const glm::mat4& projectionMatrix;
+    };
+    // Draws the static objects and the dynamic objects in the view frustum.
+    // The draw list and the culling scratch come from the packet's own
+    // arena, released whole by the next capture; each packet in flight
+    // having its own, one is captured while another is drawn.
+    void capture(CaptureArguments arguments)
+    {
+        const auto& [scene, viewMatrix, projectionMatrix] = arguments;
+
+        this->draws = {};
+        this->arena.reset();
+
+        this->viewMatrix = viewMatrix;
+        this->projectionMatrix = projectionMatrix;
+
+        const auto staticObjects = scene.getStaticObjects();
+        const auto dynamicObjects = scene.getDynamicObjects();
+        const auto modelMatrices =
+            scene.getTransformStore().getModelMatrices();
+
+        auto visibleObjects = std::pmr::vector<size_t>(&this->arena);
+        visibleObjects.reserve(dynamicObjects.size());
+        scene.findVisibleDynamicObjects(
+            DynamicAabbTree::Frustum::fromMatrix(projectionMatrix * viewMatrix),
+            visibleObjects);
+
+        const auto draws =
+            this->arena.allocateArray<Draw>(
+                staticObjects.size() + visibleObjects.size());
+
+        auto draw = draws.begin();
+        for (const auto& staticObject : staticObjects)
+        {
+            *draw++ =
+                Draw
+                {
+                    .model = &staticObject.model,
+                    .modelMatrix =
+                        glm::make_mat4(staticObject.modelMatrix.data())
+                };
+        }
+
+        for (const auto index : visibleObjects)
+        {
+            const auto& dynamicObject = dynamicObjects[index];
+            *draw++ =
+                Draw
+                {
+                    .model = &dynamicObject.model,
+                    .materialChunks = dynamicObject.materialChunks,
+                    .modelMatrix = modelMatrices[dynamicObject.transformIndex]
+                };
+        }
+
+        this->draws = draws;
+    }
+
+private:
+    FrameArena arena = FrameArena({});
+};
+} // namespace ctoAssetsRTIS
@@ -48,6 +48,12 @@ public:
         return this->viewportDimensions;
     }
 
+    // Unlike wasUpdated, leaves the update pending.
+    bool isUpdatePending() const
+    {
+        return this->updated;
+    }
+
     bool wasUpdated()
     {
         if (!this->updated)
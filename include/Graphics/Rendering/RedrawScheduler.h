@@ -0,0 +1,97 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <stdexcept>
+
+
+namespace ctoAssetsRTIS
+{
+// Decides each frame whether to render. A requested redraw renders on the
+// next frame; otherwise the view is redrawn once per idleFrameInterval.
+// Hidden windows render at most once per hiddenFrameInterval, requested
+// or not, and are redrawn once they are shown again. Intervals are in
+// milliseconds and may be infinite.
+class RedrawScheduler
+{
+public:
+    struct Configuration
+    {
+        float idleFrameInterval;
+        float hiddenFrameInterval;
+    };
+    RedrawScheduler(Configuration configuration)
+    : idleFrameInterval{ configuration.idleFrameInterval }
+    , hiddenFrameInterval{ configuration.hiddenFrameInterval }
+    {
+        if (!(this->idleFrameInterval > 0.0f)
+            || !(this->hiddenFrameInterval > 0.0f))
+        {
+            throw std::invalid_argument(
+                "idleFrameInterval and hiddenFrameInterval must be greater "
+                "than 0");
+        }
+    }
+
+    RedrawScheduler(const RedrawScheduler&) = delete;
+    RedrawScheduler(RedrawScheduler&&) = delete;
+    RedrawScheduler& operator=(const RedrawScheduler&) = delete;
+
+    void requestRedraw()
+    {
+        this->redrawRequested = true;
+    }
+
+    struct FrameArguments
+    {
+        double now;
+        bool hidden;
+    };
+    bool shouldRender(FrameArguments arguments)
+    {
+        const auto [now, hidden] = arguments;
+
+        if (this->hidden && !hidden)
+        {
+            this->redrawRequested = true;
+        }
+        this->hidden = hidden;
+
+        if (this->getTimeUntilNextFrame(now) > 0.0f)
+        {
+            return false;
+        }
+
+        this->redrawRequested = false;
+        this->lastFrameTime = now;
+
+        return true;
+    }
+
+    // Time from now until shouldRender would next render without a new
+    // request, in milliseconds.
+    float getTimeUntilNextFrame(double now) const
+    {
+        const auto interval =
+            this->hidden
+                ? this->hiddenFrameInterval
+                : this->redrawRequested ? 0.0f : this->idleFrameInterval;
+
+        return
+            static_cast<float>(
+                static_cast<double>(interval) - (now - this->lastFrameTime));
+    }
+
+private:
+    float idleFrameInterval;
+    float hiddenFrameInterval;
+
+    bool redrawRequested = true;
+    bool hidden = false;
+    double lastFrameTime = 0.0;
+};
+} // namespace ctoAssetsRTIS
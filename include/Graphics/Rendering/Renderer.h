@@ -6,10 +6,11 @@
 
 #pragma once
 
+#include <span>
+
 #include "FragmentShader.h"
+#include "FramePacket.h"
 #include "Shader.h"
-#include "Simulation/FixedRateTimer.h"
-#include "Simulation/SimulationObject.h"
 #include "VertexShader.h"
 
 
@@ -18,71 +19,53 @@ namespace ctoAssetsRTIS
 class Renderer
 {
 public:
-    struct RendererConfiguration
-    {
-        Camera& camera;
-        ProjectionMatrixManager& projectionMatrixManager;
-    };
-    Renderer(RendererConfiguration configuration)
-    : camera{ configuration.camera }
-    , projectionMatrixManager{ configuration.projectionMatrixManager }
+    Renderer()
     {
         this->shader.use();
-        this->shader.set(
-            "projection",
-            this->projectionMatrixManager.getMatrix());
     }
 
-    void render(std::span<const SimulationObject> simulationObjects)
+    // Reads nothing but the packet, so it may be captured on another thread.
+    void render(const FramePacket& framePacket)
     {
-        this->shader.set("view", this->camera.getViewMatrix());
+        this->shader.set("view", framePacket.viewMatrix);
+        this->shader.set("projection", framePacket.projectionMatrix);
 
-        if (this->projectionMatrixManager.wasUpdated())
+        for (const auto& draw : framePacket.draws)
         {
-            this->shader.set(
-                "projection",
-                this->projectionMatrixManager.getMatrix());
+            this->shader.set("model", draw.modelMatrix);
+            this->drawModel(*draw.model, draw.materialChunks);
         }
+    }
 
-        const auto drawModel =
-        [&](const auto& model)
+private:
+    void drawModel(
+        const Model& model,
+        std::span<const MeshData::MaterialChunk> materialChunks = {}) const
+    {
+        const auto meshContext = model.mesh.bind();
+        for (const auto& materialChunk :
+            materialChunks.empty() ? model.mesh.materialChunks : materialChunks)
         {
-            const auto meshContext = model.mesh.bind();
-            for (const auto& materialChunk : model.mesh.materialChunks)
-            {
-                const auto& materialDefinition =
-                    model.materialLibrary.find(materialChunk.name);
-
-                const auto& diffuseColor = materialDefinition.diffuseColor;
-                this->shader.set(
-                    "color",
-                    glm::vec4(
-                        diffuseColor[0],
-                        diffuseColor[1],
-                        diffuseColor[2],
-                        1.0f));
-
-                glDrawElements(
-                    GL_TRIANGLES,
-                    materialChunk.count,
-                    GL_UNSIGNED_INT,
-                    (void*)(materialChunk.offset * sizeof(GLuint)));
-            }
-        };
+            const auto& materialDefinition =
+                model.materialLibrary.find(materialChunk.name);
 
-        for (const auto& simulationObject : simulationObjects)
-        {
+            const auto& diffuseColor = materialDefinition.diffuseColor;
             this->shader.set(
-                "model",
-                simulationObject
-                    .transform
-                    .getModelMatrix());
+                "color",
+                glm::vec4(
+                    diffuseColor[0],
+                    diffuseColor[1],
+                    diffuseColor[2],
+                    1.0f));
 
-            drawModel(simulationObject.model);
+            glDrawElements(
+                materialChunk.primitiveMode,
+                materialChunk.count,
+                GL_UNSIGNED_INT,
+                (void*)(materialChunk.offset * sizeof(GLuint)));
         }
     }
 
-private:
     const Shader shader =
         Shader(
             Shader::SourcePaths
@@ -90,8 +73,5 @@ private:
                 .vertex = fileContents::VertexShaderCode::value.data,
                 .fragment = fileContents::FragmentShaderCode::value.data
             });
-
-    Camera& camera;
-    ProjectionMatrixManager& projectionMatrixManager;
 };
 } // namespace ctoAssetsRTIS
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <array>
 #include <format>
 #include <fstream>
 #include <iostream>
@@ -204,6 +205,18 @@ public:
             &value[0][0]);
     }
 
+    void set(const char* uniformName, const std::array<float, 16>& value) const
+    {
+        const auto count = 1;
+        const auto transpose = GL_FALSE;
+
+        glUniformMatrix4fv(
+            getUniform(uniformName),
+            count,
+            transpose,
+            value.data());
+    }
+
     void set(const char* uniformName, const glm::vec4& value) const
     {
         const auto count = 1;
@@ -0,0 +1,98 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+namespace ctoAssetsRTIS
+{
+struct InputEvent
+{
+    enum class Type : std::uint8_t
+    {
+        CursorMoved,
+        ButtonChanged,
+        TouchMoved,
+        TouchEnded,
+        KeyChanged
+    };
+
+    Type type;
+    bool pressed = false;
+    int key = 0;
+    glm::vec2 position = glm::vec2();
+
+    // Milliseconds, on the FixedRateTimer clock.
+    double timestamp;
+};
+
+// Single-producer, single-consumer ring of input events: the producer is
+// the thread running the window system's callbacks, the consumer the one
+// draining them. Neither side blocks, and a full ring drops new events.
+class InputEventQueue
+{
+public:
+    static constexpr auto capacity = size_t{ 4096 };
+
+    InputEventQueue() = default;
+
+    InputEventQueue(const InputEventQueue&) = delete;
+    InputEventQueue(InputEventQueue&&) = delete;
+    InputEventQueue& operator=(const InputEventQueue&) = delete;
+
+    bool push(const InputEvent& event)
+    {
+        const auto tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - this->head.load(std::memory_order_acquire) == capacity)
+        {
+            this->droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        this->events[tail % capacity] = event;
+        this->tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Visits, in order, every event pushed before the call, and returns how
+    // many there were.
+    template<typename Visitor>
+    size_t drain(Visitor&& visitor)
+    {
+        const auto head = this->head.load(std::memory_order_relaxed);
+        const auto tail = this->tail.load(std::memory_order_acquire);
+
+        for (auto i = head; i != tail; i++)
+        {
+            visitor(this->events[i % capacity]);
+        }
+
+        this->head.store(tail, std::memory_order_release);
+
+        return tail - head;
+    }
+
+    size_t getDroppedCount() const
+    {
+        return this->droppedCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<InputEvent> events = std::vector<InputEvent>(capacity);
+
+    alignas(64) std::atomic<size_t> head = 0;
+    alignas(64) std::atomic<size_t> tail = 0;
+    std::atomic<size_t> droppedCount = 0;
+};
+} // namespace ctoAssetsRTIS
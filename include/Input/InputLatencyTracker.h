@@ -0,0 +1,177 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <format>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+
+#include <GL/glew.h>
+
+#include "Simulation/DurationHistogram.h"
+#include "Simulation/FixedRateTimer.h"
+
+
+namespace ctoAssetsRTIS
+{
+// Follows the earliest cursor sample applied in a frame from its callback
+// timestamp through the update that applied it, the submission of the
+// frame's draw calls, and the completion of the frame, and records one
+// latency of each kind per such frame. Completion is taken after glFinish,
+// which drains the pipeline and so costs throughput: the tracker is for
+// measurement runs. Given a reportStream, the percentiles are written to it
+// once per reportInterval.
+class InputLatencyTracker
+{
+public:
+    struct Configuration
+    {
+        std::ostream* reportStream = nullptr;
+        float reportInterval = 10000.0f;
+    };
+    InputLatencyTracker(Configuration configuration)
+    : reportStream{ configuration.reportStream }
+    , reportInterval{ configuration.reportInterval }
+    {
+        if (this->reportStream && !(this->reportInterval > 0.0f))
+        {
+            throw std::invalid_argument(
+                "reportInterval must be greater than 0");
+        }
+    }
+
+    InputLatencyTracker(const InputLatencyTracker&) = delete;
+    InputLatencyTracker(InputLatencyTracker&&) = delete;
+    InputLatencyTracker& operator=(const InputLatencyTracker&) = delete;
+
+    // Called once an update has applied input sampled at inputTimestamp,
+    // or, for an update made on another thread, with the time it was made.
+    // Only the earliest input of a frame is followed.
+    void recordUpdate(double inputTimestamp, double updateTimestamp = getNow())
+    {
+        if (this->pendingFrame)
+        {
+            return;
+        }
+
+        this->pendingFrame =
+            PendingFrame
+            {
+                .inputTimestamp = inputTimestamp,
+                .updateTimestamp = updateTimestamp
+            };
+    }
+
+    void recordSubmit()
+    {
+        if (this->pendingFrame)
+        {
+            this->pendingFrame->submitTimestamp = getNow();
+        }
+    }
+
+    // Blocks until the frame has finished rendering. Frames that were not
+    // presented keep their input pending for the next one.
+    void recordPresent(bool presented)
+    {
+        if (!this->pendingFrame || !presented)
+        {
+            return;
+        }
+
+        glFinish();
+        const auto presentTimestamp = getNow();
+
+        const auto [inputTimestamp, updateTimestamp, submitTimestamp] =
+            *this->pendingFrame;
+        this->pendingFrame.reset();
+
+        this->inputToUpdate.record(updateTimestamp - inputTimestamp);
+        this->inputToSubmit.record(submitTimestamp - inputTimestamp);
+        this->inputToPresent.record(presentTimestamp - inputTimestamp);
+
+        if (this->reportStream
+            && presentTimestamp - this->lastReportTime >= this->reportInterval)
+        {
+            this->writeReport(*this->reportStream);
+            this->lastReportTime = presentTimestamp;
+        }
+    }
+
+    const DurationHistogram& getInputToUpdate() const
+    {
+        return this->inputToUpdate;
+    }
+
+    const DurationHistogram& getInputToSubmit() const
+    {
+        return this->inputToSubmit;
+    }
+
+    const DurationHistogram& getInputToPresent() const
+    {
+        return this->inputToPresent;
+    }
+
+    void writeReport(std::ostream& stream) const
+    {
+        auto output = std::ostreambuf_iterator<char>(stream);
+
+        output =
+            std::format_to(
+                output,
+                "latency samples {}",
+                this->inputToPresent.getCount());
+
+        const auto writeHistogram =
+        [&](const char* name, const DurationHistogram& histogram)
+        {
+            output =
+                std::format_to(
+                    output,
+                    " | {} ms p50 {:.2f} p95 {:.2f} p99 {:.2f} max {:.2f}",
+                    name,
+                    histogram.getPercentile(50.0f),
+                    histogram.getPercentile(95.0f),
+                    histogram.getPercentile(99.0f),
+                    histogram.getMaximum());
+        };
+
+        writeHistogram("update", this->inputToUpdate);
+        writeHistogram("submit", this->inputToSubmit);
+        writeHistogram("present", this->inputToPresent);
+
+        *output++ = '\n';
+        stream.flush();
+    }
+
+private:
+    struct PendingFrame
+    {
+        double inputTimestamp;
+        double updateTimestamp;
+        double submitTimestamp = 0.0;
+    };
+
+    static double getNow()
+    {
+        return FixedRateTimer<float>::getTotalElapsedTimeMilliseconds().count();
+    }
+
+    std::ostream* reportStream;
+    float reportInterval;
+    double lastReportTime = 0.0;
+
+    std::optional<PendingFrame> pendingFrame;
+
+    DurationHistogram inputToUpdate;
+    DurationHistogram inputToSubmit;
+    DurationHistogram inputToPresent;
+};
+} // namespace ctoAssetsRTIS
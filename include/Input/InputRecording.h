@@ -0,0 +1,311 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "InputStates.h"
+#include "Window/ViewportDimensions.h"
+
+
+namespace ctoAssetsRTIS
+{
+// A log of the input each fixed simulation step applied, grouped by frame
+// with the frame's duration and viewport. Replaying the frame durations
+// through the same fixed timestep runs the same steps, and each step sees
+// exactly the recorded input, so the simulation is reproduced bit for bit.
+//
+// After the header, each frame is a FrameEntry followed by stepCount
+// StepEntries.
+struct InputRecording
+{
+    static constexpr auto magic =
+        std::array<char, 8>{ 'C', 'T', 'O', 'I', 'N', 'P', 'U', 'T' };
+    static constexpr auto version = std::uint32_t{ 1 };
+
+    struct Header
+    {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        float stepDuration;
+        std::uint32_t maximumStepsPerFrame;
+        std::uint32_t reserved;
+    };
+
+    struct FrameEntry
+    {
+        std::uint64_t frameIndex;
+        float frameDuration;
+        std::uint32_t stepCount;
+        std::int32_t viewportWidth;
+        std::int32_t viewportHeight;
+    };
+
+    struct StepEntry
+    {
+        std::array<float, 2> cursorMotion;
+        std::uint32_t flags;
+    };
+
+    static_assert(std::endian::native == std::endian::little);
+
+    // Only what Camera::update reads is kept.
+    static StepEntry encode(const InputStates& inputStates)
+    {
+        const auto& [mouseStates, keyStates] = inputStates;
+
+        const auto flags =
+            std::to_array<bool>({
+                mouseStates.buttonPressed,
+                mouseStates.touchActive,
+                keyStates.wPressed,
+                keyStates.aPressed,
+                keyStates.sPressed,
+                keyStates.dPressed,
+                keyStates.qPressed,
+                keyStates.ePressed
+            });
+
+        auto result =
+            StepEntry
+            {
+                .cursorMotion =
+                    { mouseStates.cursorMotion.x, mouseStates.cursorMotion.y },
+                .flags = 0
+            };
+
+        for (auto i = size_t{}; i < flags.size(); i++)
+        {
+            result.flags |= static_cast<std::uint32_t>(flags[i]) << i;
+        }
+
+        return result;
+    }
+
+    static InputStates decode(const StepEntry& stepEntry)
+    {
+        const auto flag =
+        [&](size_t bit)
+        {
+            return ((stepEntry.flags >> bit) & 1) != 0;
+        };
+
+        auto result = InputStates{};
+        result.mouseStates.cursorMotion =
+            glm::vec2(stepEntry.cursorMotion[0], stepEntry.cursorMotion[1]);
+        result.mouseStates.buttonPressed = flag(0);
+        result.mouseStates.touchActive = flag(1);
+        result.keyStates.wPressed = flag(2);
+        result.keyStates.aPressed = flag(3);
+        result.keyStates.sPressed = flag(4);
+        result.keyStates.dPressed = flag(5);
+        result.keyStates.qPressed = flag(6);
+        result.keyStates.ePressed = flag(7);
+
+        return result;
+    }
+};
+
+class InputRecorder
+{
+public:
+    struct Configuration
+    {
+        std::ostream& stream;
+        float stepDuration;
+        size_t maximumStepsPerFrame;
+    };
+    InputRecorder(Configuration configuration)
+    : stream{ configuration.stream }
+    {
+        const auto header =
+            InputRecording::Header
+            {
+                .magic = InputRecording::magic,
+                .version = InputRecording::version,
+                .stepDuration = configuration.stepDuration,
+                .maximumStepsPerFrame =
+                    static_cast<std::uint32_t>(
+                        configuration.maximumStepsPerFrame),
+                .reserved = 0
+            };
+        this->write(&header, sizeof(header));
+
+        this->pendingSteps.reserve(configuration.maximumStepsPerFrame);
+    }
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder(InputRecorder&&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    void recordStep(const InputStates& inputStates)
+    {
+        this->pendingSteps.push_back(InputRecording::encode(inputStates));
+    }
+
+    struct FrameArguments
+    {
+        float frameDuration;
+        ViewportDimensions viewportDimensions;
+    };
+    void endFrame(FrameArguments arguments)
+    {
+        const auto frameEntry =
+            InputRecording::FrameEntry
+            {
+                .frameIndex = this->frameIndex++,
+                .frameDuration = arguments.frameDuration,
+                .stepCount =
+                    static_cast<std::uint32_t>(this->pendingSteps.size()),
+                .viewportWidth = arguments.viewportDimensions.getWidth(),
+                .viewportHeight = arguments.viewportDimensions.getHeight()
+            };
+        this->write(&frameEntry, sizeof(frameEntry));
+        this->write(
+            this->pendingSteps.data(),
+            this->pendingSteps.size() * sizeof(InputRecording::StepEntry));
+
+        this->pendingSteps.clear();
+    }
+
+private:
+    void write(const void* data, size_t size)
+    {
+        this->stream.write(
+            static_cast<const char*>(data),
+            static_cast<std::streamsize>(size));
+
+        if (!this->stream)
+        {
+            throw std::runtime_error("Failed to write input recording");
+        }
+    }
+
+    std::ostream& stream;
+    std::vector<InputRecording::StepEntry> pendingSteps;
+    std::uint64_t frameIndex = 0;
+};
+
+class InputReplay
+{
+public:
+    InputReplay(std::span<const std::byte> bytes)
+    : bytes{ bytes }
+    , header{ this->read<InputRecording::Header>() }
+    {
+        if (this->header.magic != InputRecording::magic)
+        {
+            throw std::runtime_error("Invalid input recording: bad magic");
+        }
+
+        if (this->header.version != InputRecording::version)
+        {
+            throw std::runtime_error(
+                std::format(
+                    "Unsupported input recording version: {}",
+                    this->header.version));
+        }
+
+        this->steps.reserve(this->header.maximumStepsPerFrame);
+    }
+
+    InputReplay(const InputReplay&) = delete;
+    InputReplay(InputReplay&&) = delete;
+    InputReplay& operator=(const InputReplay&) = delete;
+
+    float getStepDuration() const
+    {
+        return this->header.stepDuration;
+    }
+
+    size_t getMaximumStepsPerFrame() const
+    {
+        return this->header.maximumStepsPerFrame;
+    }
+
+    struct Frame
+    {
+        std::uint64_t frameIndex;
+        float frameDuration;
+        ViewportDimensions viewportDimensions;
+        std::span<const InputStates> steps;
+    };
+    // Empty once the recording is exhausted. The steps are valid until the
+    // next call.
+    std::optional<Frame> nextFrame()
+    {
+        if (this->position == this->bytes.size())
+        {
+            return std::nullopt;
+        }
+
+        const auto frameEntry = this->read<InputRecording::FrameEntry>();
+        if (frameEntry.stepCount > this->header.maximumStepsPerFrame)
+        {
+            throw std::runtime_error(
+                std::format(
+                    "Invalid input recording: frame {} has {} steps",
+                    frameEntry.frameIndex,
+                    frameEntry.stepCount));
+        }
+
+        this->steps.clear();
+        for (auto i = std::uint32_t{}; i < frameEntry.stepCount; i++)
+        {
+            this->steps.push_back(
+                InputRecording::decode(
+                    this->read<InputRecording::StepEntry>()));
+        }
+
+        return
+            Frame
+            {
+                .frameIndex = frameEntry.frameIndex,
+                .frameDuration = frameEntry.frameDuration,
+                .viewportDimensions =
+                    ViewportDimensions({
+                        .width = frameEntry.viewportWidth,
+                        .height = frameEntry.viewportHeight
+                    }),
+                .steps = this->steps
+            };
+    }
+
+private:
+    template<typename T>
+    T read()
+    {
+        if (this->bytes.size() - this->position < sizeof(T))
+        {
+            throw std::runtime_error("Invalid input recording: truncated");
+        }
+
+        auto result = T{};
+        std::memcpy(&result, this->bytes.data() + this->position, sizeof(T));
+        this->position += sizeof(T);
+
+        return result;
+    }
+
+    std::span<const std::byte> bytes;
+    size_t position = 0;
+    InputRecording::Header header;
+    std::vector<InputStates> steps;
+};
+} // namespace ctoAssetsRTIS
@@ -49,12 +49,20 @@ struct KeyStates
                 break;
         }
     }
+
+    bool operator==(const KeyStates&) const = default;
 };
 
 struct MouseStates
 {
     glm::vec2 lastCursorPosition = glm::vec2();
     glm::vec2 currentCursorPosition = glm::vec2();
+
+    // Summed over every cursor or touch sample since it was last cleared,
+    // with the timestamp of the earliest of them.
+    glm::vec2 cursorMotion = glm::vec2();
+    double cursorMotionTimestamp = 0.0;
+
     bool buttonPressed = false;
     bool touchActive = false;
     bool firstMove = true;
@@ -69,11 +77,15 @@ struct MouseStates
 
         return *mouseStatesPointer;
     }
+
+    bool operator==(const MouseStates&) const = default;
 };
 
 struct InputStates
 {
     MouseStates mouseStates;
     KeyStates keyStates;
+
+    bool operator==(const InputStates&) const = default;
 };
 } // namespace ctoAssetsRTIS
@@ -6,15 +6,28 @@
 
 #pragma once
 
+#include <cmath>
 #include <memory>
 
 #include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
 
 #include "Graphics/Camera/Camera.h"
+#include "InputEventQueue.h"
 #include "InputStates.h"
+#include "Simulation/FixedRateTimer.h"
+#include "Window/ViewportDimensions.h"
 
 namespace ctoAssetsRTIS
 {
+// Callbacks only queue timestamped events; the states change when
+// processEvents drains the queue, which is best done just before the states
+// are read. Every cursor sample drained adds to MouseStates::cursorMotion,
+// so motion between frames is integrated rather than sampled.
+//
+// pollEvents and waitEvents run the callbacks and must be called on the
+// thread that created the window. The states, and processEvents, belong to
+// whichever single thread reads them.
 class InputSystem
 {
 public:
@@ -32,13 +45,13 @@ public:
 #ifdef __EMSCRIPTEN__
         emscripten_set_touchmove_callback(
             EMSCRIPTEN_EVENT_TARGET_WINDOW,
-            &this->states.mouseStates,
+            &this->eventQueue,
             EM_FALSE,
             touchMoveCallback);
 
         emscripten_set_touchend_callback(
             EMSCRIPTEN_EVENT_TARGET_WINDOW,
-            &this->states.mouseStates,
+            &this->eventQueue,
             EM_FALSE,
             touchEndCallback);
 #endif
@@ -53,55 +66,212 @@ public:
     {
         return glfwWindowShouldClose(this->window.get());
     }
+
+    void requestExit() const
+    {
+        glfwSetWindowShouldClose(this->window.get(), GLFW_TRUE);
+    }
 #endif
 
-    void pollEvents() const
+    void pollEvents()
     {
         glfwPollEvents();
     }
 
-    InputStates& getStates()
+    // Cursor positions are clamped to the viewport before their motion is
+    // summed, so dragging outside the window adds none.
+    void processEvents(ViewportDimensions viewportDimensions)
+    {
+        this->eventQueue.drain(
+            [&](const InputEvent& event)
+            {
+                this->apply(event, viewportDimensions);
+            });
+
+        this->detectChange();
+    }
+
+#ifndef __EMSCRIPTEN__
+    // Blocks until an event arrives or the timeout, which may be infinite,
+    // elapses.
+    void waitEvents(float timeoutMilliseconds)
+    {
+        if (std::isinf(timeoutMilliseconds))
+        {
+            glfwWaitEvents();
+        }
+        else
+        {
+            glfwWaitEventsTimeout(timeoutMilliseconds / 1000.0);
+        }
+    }
+
+    // Ends a waitEvents in progress, or the next one. May be called from
+    // any thread.
+    void interruptWait() const
+    {
+        glfwPostEmptyEvent();
+    }
+#endif
+
+    // Whether the states differ from those after the previous poll.
+    bool hasChanged() const
+    {
+        return this->changed;
+    }
+
+    const InputStates& getStates() const
     {
         return this->states;
     }
 
+    // Called once the motion has been applied, so it is applied only once.
+    void clearCursorMotion()
+    {
+        this->states.mouseStates.cursorMotion = glm::vec2();
+    }
+
+    // Queued behind any events from the callbacks, and so must be called on
+    // the thread that runs them, the queue's only producer.
+    bool injectEvent(const InputEvent& event)
+    {
+        return this->eventQueue.push(event);
+    }
+
+    size_t getDroppedEventCount() const
+    {
+        return this->eventQueue.getDroppedCount();
+    }
+
 private:
     const std::shared_ptr<GLFWwindow> window;
+    InputEventQueue eventQueue;
     InputStates states;
+    InputStates previousStates;
+    bool changed = true;
 
-#ifdef __EMSCRIPTEN__
-    static int touchMoveCallback(
-        int /* eventType */,
-        const EmscriptenTouchEvent* event,
-        void* userData)
+    static double getTimestamp()
     {
-        auto& mouseStates = MouseStates::fromPointer(userData);
-        if (event->numTouches <= 0)
+        return FixedRateTimer<float>::getTotalElapsedTimeMilliseconds().count();
+    }
+
+    static InputEventQueue& getEventQueue(GLFWwindow* window)
+    {
+        return
+            ApplicationStateManager
+                ::getStateFromWindow(window)
+                .inputSystem
+                .eventQueue;
+    }
+
+    void apply(const InputEvent& event, ViewportDimensions viewportDimensions)
+    {
+        auto& mouseStates = this->states.mouseStates;
+
+        switch (event.type)
         {
-            mouseStates.touchActive = false;
-            return EM_TRUE;
+            case InputEvent::Type::CursorMoved:
+                if (!mouseStates.touchActive)
+                {
+                    this->moveCursor(event, viewportDimensions);
+                }
+                break;
+            case InputEvent::Type::TouchMoved:
+                mouseStates.touchActive = true;
+                this->moveCursor(event, viewportDimensions);
+                break;
+            case InputEvent::Type::TouchEnded:
+                mouseStates.touchActive = false;
+                break;
+            case InputEvent::Type::ButtonChanged:
+                if (!event.pressed)
+                {
+                    mouseStates.touchActive = false;
+                    mouseStates.buttonPressed = false;
+                }
+                else if (!mouseStates.touchActive)
+                {
+                    mouseStates.buttonPressed = true;
+                }
+                break;
+            case InputEvent::Type::KeyChanged:
+                this->states.keyStates.setKeyState(event.key, event.pressed);
+                break;
         }
+    }
 
-        mouseStates.touchActive = true;
-
-        const auto clientX =  event->touches[0].clientX;
-        const auto clientY =  event->touches[0].clientY;
+    void moveCursor(
+        const InputEvent& event,
+        ViewportDimensions viewportDimensions)
+    {
+        auto& mouseStates = this->states.mouseStates;
 
         if (mouseStates.firstMove)
         {
-            mouseStates.currentCursorPosition.x = clientX;
-            mouseStates.currentCursorPosition.y = clientY;
-
-            mouseStates.lastCursorPosition = mouseStates.currentCursorPosition;
+            mouseStates.currentCursorPosition = event.position;
+            mouseStates.lastCursorPosition = event.position;
 
             mouseStates.firstMove = false;
-            return EM_TRUE;
+            return;
         }
 
+        const auto clampToViewportDimensions =
+        [&](const glm::vec2& position)
+        {
+            return
+                glm::clamp(
+                    position,
+                    glm::vec2(),
+                    glm::vec2(
+                        viewportDimensions.getWidth(),
+                        viewportDimensions.getHeight()));
+        };
+
+        const auto motion =
+            clampToViewportDimensions(event.position)
+                - clampToViewportDimensions(
+                    mouseStates.currentCursorPosition);
+
+        if (mouseStates.cursorMotion == glm::vec2())
+        {
+            mouseStates.cursorMotionTimestamp = event.timestamp;
+        }
+        mouseStates.cursorMotion += motion;
+
         mouseStates.lastCursorPosition = mouseStates.currentCursorPosition;
+        mouseStates.currentCursorPosition = event.position;
+    }
 
-        mouseStates.currentCursorPosition.x = clientX;
-        mouseStates.currentCursorPosition.y = clientY;
+    void detectChange()
+    {
+        this->changed = this->states != this->previousStates;
+        this->previousStates = this->states;
+    }
+
+#ifdef __EMSCRIPTEN__
+    static int touchMoveCallback(
+        int /* eventType */,
+        const EmscriptenTouchEvent* event,
+        void* userData)
+    {
+        auto& eventQueue = *static_cast<InputEventQueue*>(userData);
+        if (event->numTouches <= 0)
+        {
+            eventQueue.push({
+                .type = InputEvent::Type::TouchEnded,
+                .timestamp = getTimestamp()
+            });
+            return EM_TRUE;
+        }
+
+        eventQueue.push({
+            .type = InputEvent::Type::TouchMoved,
+            .position =
+                glm::vec2(
+                    event->touches[0].clientX,
+                    event->touches[0].clientY),
+            .timestamp = getTimestamp()
+        });
 
         return EM_TRUE;
     }
@@ -111,7 +281,10 @@ private:
         const EmscriptenTouchEvent* /* event */,
         void* userData)
     {
-        MouseStates::fromPointer(userData).touchActive = false;
+        static_cast<InputEventQueue*>(userData)->push({
+            .type = InputEvent::Type::TouchEnded,
+            .timestamp = getTimestamp()
+        });
         return EM_TRUE;
     }
 #endif
@@ -121,33 +294,11 @@ private:
         double xPos,
         double yPos)
     {
-        auto& mouseStates =
-            ApplicationStateManager
-                ::getStateFromWindow(window)
-                .inputSystem
-                .getStates()
-                .mouseStates;
-
-        if (mouseStates.touchActive)
-        {
-            return;
-        }
-
-        if (mouseStates.firstMove)
-        {
-            mouseStates.currentCursorPosition.x = xPos;
-            mouseStates.currentCursorPosition.y = yPos;
-
-            mouseStates.lastCursorPosition = mouseStates.currentCursorPosition;
-
-            mouseStates.firstMove = false;
-            return;
-        }
-
-        mouseStates.lastCursorPosition = mouseStates.currentCursorPosition;
-
-        mouseStates.currentCursorPosition.x = xPos;
-        mouseStates.currentCursorPosition.y = yPos;
+        getEventQueue(window).push({
+            .type = InputEvent::Type::CursorMoved,
+            .position = glm::vec2(xPos, yPos),
+            .timestamp = getTimestamp()
+        });
     }
 
     static void mouseButtonCallback(
@@ -156,28 +307,17 @@ private:
         int action,
         int /* mods */)
     {
-        auto& mouseStates =
-            ApplicationStateManager
-                ::getStateFromWindow(window)
-                .inputSystem
-                .getStates()
-                .mouseStates;
-
-        if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE)
-        {
-            mouseStates.touchActive = false;
-            mouseStates.buttonPressed = false;
-        }
-
-        if (mouseStates.touchActive)
+        if (button != GLFW_MOUSE_BUTTON_LEFT
+            || (action != GLFW_PRESS && action != GLFW_RELEASE))
         {
             return;
         }
 
-        if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
-        {
-            mouseStates.buttonPressed = true;
-        }
+        getEventQueue(window).push({
+            .type = InputEvent::Type::ButtonChanged,
+            .pressed = action == GLFW_PRESS,
+            .timestamp = getTimestamp()
+        });
     }
 
     static void keyCallback(
@@ -194,13 +334,12 @@ private:
         }
 #endif
 
-        bool keyPressed = action == GLFW_PRESS || action == GLFW_REPEAT;
-        ApplicationStateManager
-            ::getStateFromWindow(window)
-            .inputSystem
-            .getStates()
-            .keyStates
-            .setKeyState(key, keyPressed);
+        getEventQueue(window).push({
+            .type = InputEvent::Type::KeyChanged,
+            .pressed = action == GLFW_PRESS || action == GLFW_REPEAT,
+            .key = key,
+            .timestamp = getTimestamp()
+        });
     }
 };
 } // namespace ctoAssetsRTIS
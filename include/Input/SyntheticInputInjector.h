@@ -0,0 +1,104 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+#include <glm/glm.hpp>
+
+#include "InputEventQueue.h"
+#include "InputSystem.h"
+
+
+namespace ctoAssetsRTIS
+{
+// Drags the cursor around a circle with the button held, as a mouse
+// reporting at sampleRate would, so latency can be measured without
+// anyone at the controls. Samples are injected once they are due and
+// stamped with the time they were due, so each waits for the frame that
+// drains it as real input would.
+class SyntheticInputInjector
+{
+public:
+    struct Configuration
+    {
+        InputSystem& inputSystem;
+        glm::vec2 center;
+        float radius;
+        float period;
+        float sampleRate;
+    };
+    SyntheticInputInjector(Configuration configuration)
+    : inputSystem{ configuration.inputSystem }
+    , center{ configuration.center }
+    , radius{ configuration.radius }
+    , period{ configuration.period }
+    , sampleInterval{ 1000.0f / configuration.sampleRate }
+    {
+        if (!(this->period > 0.0f) || !(configuration.sampleRate > 0.0f))
+        {
+            throw std::invalid_argument(
+                "period and sampleRate must be greater than 0");
+        }
+    }
+
+    SyntheticInputInjector(const SyntheticInputInjector&) = delete;
+    SyntheticInputInjector(SyntheticInputInjector&&) = delete;
+    SyntheticInputInjector& operator=(const SyntheticInputInjector&) = delete;
+
+    // Injects every sample due by now, in milliseconds.
+    void update(double now)
+    {
+        if (!this->started)
+        {
+            this->inputSystem.injectEvent({
+                .type = InputEvent::Type::ButtonChanged,
+                .pressed = true,
+                .timestamp = now
+            });
+
+            this->startTime = now;
+            this->nextSampleTime = now;
+            this->started = true;
+        }
+
+        while (this->nextSampleTime <= now)
+        {
+            const auto angle =
+                2.0f
+                    * std::numbers::pi_v<float>
+                    * static_cast<float>(
+                        this->nextSampleTime - this->startTime)
+                    / this->period;
+
+            this->inputSystem.injectEvent({
+                .type = InputEvent::Type::CursorMoved,
+                .position =
+                    this->center
+                        + this->radius
+                            * glm::vec2(std::cos(angle), std::sin(angle)),
+                .timestamp = this->nextSampleTime
+            });
+
+            this->nextSampleTime += this->sampleInterval;
+        }
+    }
+
+private:
+    InputSystem& inputSystem;
+    glm::vec2 center;
+    float radius;
+    float period;
+    float sampleInterval;
+
+    bool started = false;
+    double startTime = 0.0;
+    double nextSampleTime = 0.0;
+};
+} // namespace ctoAssetsRTIS
@@ -0,0 +1,163 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+
+
+namespace ctoAssetsRTIS
+{
+// Counts heap allocations in builds with TRACK_ALLOCATIONS defined, where
+// main.cpp replaces the global allocation functions, or on the web malloc
+// itself, with ones that report here. In other builds the counts stay 0.
+class AllocationTracker
+{
+public:
+    struct Counts
+    {
+        std::uint64_t allocationCount = 0;
+        std::uint64_t byteCount = 0;
+
+        Counts operator-(const Counts& other) const
+        {
+            return
+                Counts
+                {
+                    .allocationCount =
+                        this->allocationCount - other.allocationCount,
+                    .byteCount = this->byteCount - other.byteCount
+                };
+        }
+    };
+
+    static constexpr bool isEnabled()
+    {
+#ifdef TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Allocates nothing, so it may be called from an allocation function,
+    // on any thread.
+    static void recordAllocation(size_t size)
+    {
+        totalAllocationCount.fetch_add(1, std::memory_order_relaxed);
+        totalByteCount.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    // Since the program started.
+    static Counts getCounts()
+    {
+        return
+            Counts
+            {
+                .allocationCount =
+                    totalAllocationCount.load(std::memory_order_relaxed),
+                .byteCount = totalByteCount.load(std::memory_order_relaxed)
+            };
+    }
+
+private:
+    static inline std::atomic<std::uint64_t> totalAllocationCount = 0;
+    static inline std::atomic<std::uint64_t> totalByteCount = 0;
+};
+
+// Fails any frame that allocates once the loop has warmed up. Allocations
+// on every thread count against the frame during which they were made.
+class AllocationCheck
+{
+public:
+    struct Configuration
+    {
+        size_t frameCount;
+    };
+    AllocationCheck(Configuration configuration)
+    : frameCount{ configuration.frameCount }
+    , previousCounts{ AllocationTracker::getCounts() }
+    {
+        if (!AllocationTracker::isEnabled())
+        {
+            throw std::runtime_error(
+                "Allocation checks need a build with TRACK_ALLOCATIONS");
+        }
+
+        if (this->frameCount == 0)
+        {
+            throw std::invalid_argument("frameCount must be greater than 0");
+        }
+    }
+
+    AllocationCheck(const AllocationCheck&) = delete;
+    AllocationCheck(AllocationCheck&&) = delete;
+    AllocationCheck& operator=(const AllocationCheck&) = delete;
+
+    struct FrameArguments
+    {
+        bool steady;
+    };
+    // Called after each frame. Frames before the first steady one are
+    // warm-up; from it on, every frame is checked. Returns whether
+    // frameCount frames have been.
+    bool endFrame(FrameArguments arguments)
+    {
+        const auto counts = AllocationTracker::getCounts();
+        const auto frameCounts = counts - this->previousCounts;
+        this->previousCounts = counts;
+
+        if (!arguments.steady && this->checkedFrameCount == 0)
+        {
+            return false;
+        }
+
+        this->checkedFrameCount++;
+        if (frameCounts.allocationCount > 0)
+        {
+            this->failedFrameCount++;
+            this->failedAllocationCount += frameCounts.allocationCount;
+            this->failedByteCount += frameCounts.byteCount;
+        }
+
+        return this->checkedFrameCount >= this->frameCount;
+    }
+
+    bool hasPassed() const
+    {
+        return this->failedFrameCount == 0;
+    }
+
+    void writeReport(std::ostream& stream) const
+    {
+        std::format_to(
+            std::ostreambuf_iterator<char>(stream),
+            "allocation check {}: {} of {} steady frames allocated,"
+            " {} allocations {} B\n",
+            this->hasPassed() ? "passed" : "failed",
+            this->failedFrameCount,
+            this->checkedFrameCount,
+            this->failedAllocationCount,
+            this->failedByteCount);
+        stream.flush();
+    }
+
+private:
+    size_t frameCount;
+    AllocationTracker::Counts previousCounts;
+
+    size_t checkedFrameCount = 0;
+    size_t failedFrameCount = 0;
+    std::uint64_t failedAllocationCount = 0;
+    std::uint64_t failedByteCount = 0;
+};
+} // namespace ctoAssetsRTIS
@@ -0,0 +1,198 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+
+namespace ctoAssetsRTIS
+{
+// Linear allocator for data that lives until the next reset. Allocating
+// bumps an offset into one buffer, deallocating does nothing, and reset
+// releases everything at once. Allocations that do not fit come from the
+// upstream resource instead, and the next reset replaces the buffer with
+// one that would have held them all, so a steady workload soon makes no
+// upstream allocations at all. Alignments stricter than a cache line
+// always come from upstream.
+//
+// As a std::pmr::memory_resource it backs pmr containers directly, which
+// must not be used past the next reset.
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+    struct Configuration
+    {
+        size_t initialCapacity = 64 * 1024;
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource();
+    };
+    FrameArena(Configuration configuration)
+    : upstream{ configuration.upstream }
+    {
+        if (configuration.initialCapacity == 0)
+        {
+            throw std::invalid_argument(
+                "initialCapacity must be greater than 0");
+        }
+
+        this->allocateBuffer(configuration.initialCapacity);
+    }
+
+    ~FrameArena()
+    {
+        this->releaseOverflow();
+        this->upstream->deallocate(
+            this->buffer,
+            this->capacity,
+            bufferAlignment);
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena(FrameArena&&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Value-initialized. Never destroyed, so T must not need to be.
+    template<typename T>
+    std::span<T> allocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>);
+
+        auto* data =
+            static_cast<T*>(this->allocate(count * sizeof(T), alignof(T)));
+        std::uninitialized_value_construct_n(data, count);
+
+        return { data, count };
+    }
+
+    void reset()
+    {
+        const auto requiredCapacity =
+            std::bit_ceil(this->capacity + this->overflowSize);
+        this->releaseOverflow();
+
+        if (requiredCapacity > this->capacity)
+        {
+            this->upstream->deallocate(
+                this->buffer,
+                this->capacity,
+                bufferAlignment);
+            this->allocateBuffer(requiredCapacity);
+        }
+
+        this->offset = 0;
+    }
+
+    size_t getCapacity() const
+    {
+        return this->capacity;
+    }
+
+    size_t getUsedSize() const
+    {
+        return this->offset + this->overflowSize;
+    }
+
+    // Since construction, including those the buffer has since grown to
+    // hold. Constant once the workload has settled.
+    std::uint64_t getUpstreamAllocationCount() const
+    {
+        return this->upstreamAllocationCount;
+    }
+
+private:
+    static constexpr auto bufferAlignment = size_t{ 64 };
+
+    struct OverflowBlock
+    {
+        void* data;
+        size_t size;
+        size_t alignment;
+    };
+
+    void* do_allocate(size_t size, size_t alignment) override
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(this->buffer);
+        const auto alignedOffset =
+            ((address + this->offset + alignment - 1) & ~(alignment - 1))
+                - address;
+
+        const auto aligned = alignment <= bufferAlignment;
+        if (aligned && alignedOffset + size <= this->capacity)
+        {
+            this->offset = alignedOffset + size;
+            return this->buffer + alignedOffset;
+        }
+
+        auto* data = this->upstream->allocate(size, alignment);
+        this->upstreamAllocationCount++;
+        this->overflowBlocks.push_back({
+            .data = data,
+            .size = size,
+            .alignment = alignment
+        });
+
+        // No buffer would hold a stricter alignment, so growing for one
+        // would not help.
+        if (aligned)
+        {
+            this->overflowSize += size + alignment;
+        }
+
+        return data;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override
+    {
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    void allocateBuffer(size_t capacity)
+    {
+        this->buffer =
+            static_cast<std::byte*>(
+                this->upstream->allocate(capacity, bufferAlignment));
+        this->capacity = capacity;
+        this->upstreamAllocationCount++;
+    }
+
+    void releaseOverflow()
+    {
+        for (const auto& block : this->overflowBlocks)
+        {
+            this->upstream->deallocate(
+                block.data,
+                block.size,
+                block.alignment);
+        }
+
+        this->overflowBlocks.clear();
+        this->overflowSize = 0;
+    }
+
+    std::pmr::memory_resource* upstream;
+    std::byte* buffer = nullptr;
+    size_t capacity = 0;
+    size_t offset = 0;
+
+    std::vector<OverflowBlock> overflowBlocks;
+    size_t overflowSize = 0;
+    std::uint64_t upstreamAllocationCount = 0;
+};
+} // namespace ctoAssetsRTIS
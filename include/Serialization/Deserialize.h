@@ -19,4 +19,13 @@ auto deserialize()
         ResultType(
             CompileTimeDeserialize<ResultType, StringProvider>::value);
 }
+
+template<typename ResultType>
+class RuntimeDeserialize;
+
+template<typename ResultType>
+auto deserialize(const RuntimeDeserialize<ResultType>& runtimeDeserialize)
+{
+    return ResultType(runtimeDeserialize.getValue());
+}
 } // namespace ctoAssetsRTIS
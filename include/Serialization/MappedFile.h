@@ -0,0 +1,192 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <cstddef>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace ctoAssetsRTIS
+{
+class MappedFile
+{
+public:
+    struct Properties
+    {
+        const char* path;
+    };
+    MappedFile(Properties properties)
+    {
+#ifdef _WIN32
+        this->fileHandle =
+            CreateFileA(
+                properties.path,
+                GENERIC_READ,
+                FILE_SHARE_READ,
+                nullptr,
+                OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                nullptr);
+
+        if (this->fileHandle == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error(
+                std::format("Failed to open file: {}", properties.path));
+        }
+
+        auto fileSize = LARGE_INTEGER{};
+        if (!GetFileSizeEx(this->fileHandle, &fileSize))
+        {
+            CloseHandle(this->fileHandle);
+            throw std::runtime_error(
+                std::format("Failed to stat file: {}", properties.path));
+        }
+
+        this->size = static_cast<size_t>(fileSize.QuadPart);
+        if (this->size == 0)
+        {
+            return;
+        }
+
+        this->mappingHandle =
+            CreateFileMappingA(
+                this->fileHandle,
+                nullptr,
+                PAGE_READONLY,
+                0,
+                0,
+                nullptr);
+
+        const auto mappedData =
+            this->mappingHandle
+                ? MapViewOfFile(this->mappingHandle, FILE_MAP_READ, 0, 0, 0)
+                : nullptr;
+
+        if (!mappedData)
+        {
+            if (this->mappingHandle)
+            {
+                CloseHandle(this->mappingHandle);
+            }
+            CloseHandle(this->fileHandle);
+            throw std::runtime_error(
+                std::format("Failed to map file: {}", properties.path));
+        }
+
+        this->data = static_cast<const std::byte*>(mappedData);
+#else
+        this->fileDescriptor = open(properties.path, O_RDONLY);
+        if (this->fileDescriptor < 0)
+        {
+            throw std::runtime_error(
+                std::format("Failed to open file: {}", properties.path));
+        }
+
+        struct stat fileStatus;
+        if (fstat(this->fileDescriptor, &fileStatus) != 0)
+        {
+            close(this->fileDescriptor);
+            throw std::runtime_error(
+                std::format("Failed to stat file: {}", properties.path));
+        }
+
+        this->size = static_cast<size_t>(fileStatus.st_size);
+        if (this->size == 0)
+        {
+            return;
+        }
+
+        const auto mappedData =
+            mmap(
+                nullptr,
+                this->size,
+                PROT_READ,
+                MAP_PRIVATE,
+                this->fileDescriptor,
+                0);
+
+        if (mappedData == MAP_FAILED)
+        {
+            close(this->fileDescriptor);
+            throw std::runtime_error(
+                std::format("Failed to map file: {}", properties.path));
+        }
+
+        madvise(mappedData, this->size, MADV_WILLNEED);
+
+        this->data = static_cast<const std::byte*>(mappedData);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (this->data)
+        {
+            UnmapViewOfFile(this->data);
+        }
+        if (this->mappingHandle)
+        {
+            CloseHandle(this->mappingHandle);
+        }
+        CloseHandle(this->fileHandle);
+#else
+        if (this->data)
+        {
+            munmap(const_cast<std::byte*>(this->data), this->size);
+        }
+        close(this->fileDescriptor);
+#endif
+    }
+
+    std::span<const std::byte> getBytes() const
+    {
+        return std::span(this->data, this->size);
+    }
+
+    std::string_view getView() const
+    {
+        return
+            std::string_view(
+                reinterpret_cast<const char*>(this->data),
+                this->size);
+    }
+
+private:
+    const std::byte* data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+};
+} // namespace ctoAssetsRTIS
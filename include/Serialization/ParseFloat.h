@@ -0,0 +1,784 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+
+namespace ctoAssetsRTIS
+{
+template<size_t LimbCount>
+class BigUnsigned
+{
+public:
+    constexpr BigUnsigned() : limbs{} {}
+
+    constexpr BigUnsigned(std::uint64_t value) : limbs{}
+    {
+        this->limbs[0] = static_cast<std::uint32_t>(value);
+        this->limbs[1] = static_cast<std::uint32_t>(value >> 32);
+    }
+
+    constexpr void multiplyAdd(std::uint32_t factor, std::uint32_t addend)
+    {
+        auto carry = std::uint64_t{ addend };
+        for (auto& limb : this->limbs)
+        {
+            const auto product = std::uint64_t{ limb } * factor + carry;
+
+            limb = static_cast<std::uint32_t>(product);
+            carry = product >> 32;
+        }
+    }
+
+    constexpr void multiplyByPowerOf(std::uint32_t base, size_t exponent)
+    {
+        for (auto i = size_t{}; i < exponent; i++)
+        {
+            this->multiplyAdd(base, 0);
+        }
+    }
+
+    constexpr void shiftLeft(size_t bits)
+    {
+        const auto limbShift = bits / 32;
+        const auto bitShift = bits % 32;
+
+        for (auto i = LimbCount; i-- > 0;)
+        {
+            auto limb = std::uint32_t{};
+            if (i >= limbShift)
+            {
+                limb = this->limbs[i - limbShift] << bitShift;
+                if (bitShift != 0 && i > limbShift)
+                {
+                    limb |= this->limbs[i - limbShift - 1] >> (32 - bitShift);
+                }
+            }
+
+            this->limbs[i] = limb;
+        }
+    }
+
+    constexpr void shiftRight(size_t bits)
+    {
+        const auto limbShift = bits / 32;
+        const auto bitShift = bits % 32;
+
+        for (auto i = size_t{}; i < LimbCount; i++)
+        {
+            auto limb = std::uint32_t{};
+            if (i + limbShift < LimbCount)
+            {
+                limb = this->limbs[i + limbShift] >> bitShift;
+                if (bitShift != 0 && i + limbShift + 1 < LimbCount)
+                {
+                    limb |= this->limbs[i + limbShift + 1] << (32 - bitShift);
+                }
+            }
+
+            this->limbs[i] = limb;
+        }
+    }
+
+    constexpr size_t getBitLength() const
+    {
+        for (auto i = LimbCount; i-- > 0;)
+        {
+            if (this->limbs[i] != 0)
+            {
+                return i * 32 + std::bit_width(this->limbs[i]);
+            }
+        }
+
+        return 0;
+    }
+
+    constexpr bool isZero() const
+    {
+        return
+            std::all_of(
+                this->limbs.begin(),
+                this->limbs.end(),
+                [](auto limb) { return limb == 0; });
+    }
+
+    constexpr bool operator>=(const BigUnsigned& other) const
+    {
+        for (auto i = LimbCount; i-- > 0;)
+        {
+            if (this->limbs[i] != other.limbs[i])
+            {
+                return this->limbs[i] > other.limbs[i];
+            }
+        }
+
+        return true;
+    }
+
+    constexpr BigUnsigned& operator-=(const BigUnsigned& other)
+    {
+        auto borrow = std::uint64_t{};
+        for (auto i = size_t{}; i < LimbCount; i++)
+        {
+            const auto difference =
+                std::uint64_t{ this->limbs[i] } - other.limbs[i] - borrow;
+
+            this->limbs[i] = static_cast<std::uint32_t>(difference);
+            borrow = difference >> 63;
+        }
+
+        return *this;
+    }
+
+    constexpr std::uint64_t divideBy(
+        BigUnsigned divisor,
+        size_t quotientBits)
+    {
+        auto quotient = std::uint64_t{};
+
+        divisor.shiftLeft(quotientBits - 1);
+        for (auto i = quotientBits; i-- > 0;)
+        {
+            if (*this >= divisor)
+            {
+                *this -= divisor;
+                quotient |= std::uint64_t{ 1 } << i;
+            }
+
+            divisor.shiftRight(1);
+        }
+
+        return quotient;
+    }
+
+private:
+    std::array<std::uint32_t, LimbCount> limbs;
+};
+
+struct FloatParseResult
+{
+    float value;
+    const char* next;
+};
+
+class FloatParser
+{
+private:
+    static constexpr auto mantissaBits = 23;
+    static constexpr auto minimumExponent = -127;
+    static constexpr auto infinitePower = 0xFF;
+    static constexpr auto smallestPowerOfTen = -64;
+    static constexpr auto largestPowerOfTen = 38;
+    static constexpr auto minimumRoundToEvenPower = -17;
+    static constexpr auto maximumRoundToEvenPower = 10;
+    static constexpr auto maximumFastPathPower = 10;
+    static constexpr auto maximumFastPathMantissa = std::uint64_t{ 1 } << 24;
+    static constexpr auto maximumMantissaDigits = 19;
+    static constexpr auto maximumExactDigits = 120;
+    static constexpr auto maximumExplicitExponent = 100000;
+
+    using BigInteger = BigUnsigned<24>;
+
+    struct UInt128
+    {
+        std::uint64_t high;
+        std::uint64_t low;
+    };
+
+    struct AdjustedMantissa
+    {
+        std::uint64_t mantissa;
+        std::int32_t power2;
+
+        constexpr bool operator==(const AdjustedMantissa&) const = default;
+    };
+
+    struct DecimalNumber
+    {
+        bool negative = false;
+        std::uint64_t mantissa = 0;
+        std::int64_t exponent = 0;
+        bool truncated = false;
+        std::string_view digits;
+        std::int64_t digitsExponent = 0;
+    };
+
+    static constexpr auto powersOfTen =
+        std::array<float, maximumFastPathPower + 1>{
+            1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+        };
+
+    // 128-bit approximations of 5^q with the top bit set, generated with
+    // the same rounding as the Eisel-Lemire reference tables.
+    static constexpr auto powersOfFive =
+        std::array<UInt128, largestPowerOfTen - smallestPowerOfTen + 1>{
+            UInt128{ 0xA87FEA27A539E9A5, 0x3F2398D747B36224 }, // 5^-64
+            UInt128{ 0xD29FE4B18E88640E, 0x8EEC7F0D19A03AAD }, // 5^-63
+            UInt128{ 0x83A3EEEEF9153E89, 0x1953CF68300424AC }, // 5^-62
+            UInt128{ 0xA48CEAAAB75A8E2B, 0x5FA8C3423C052DD7 }, // 5^-61
+            UInt128{ 0xCDB02555653131B6, 0x3792F412CB06794D }, // 5^-60
+            UInt128{ 0x808E17555F3EBF11, 0xE2BBD88BBEE40BD0 }, // 5^-59
+            UInt128{ 0xA0B19D2AB70E6ED6, 0x5B6ACEAEAE9D0EC4 }, // 5^-58
+            UInt128{ 0xC8DE047564D20A8B, 0xF245825A5A445275 }, // 5^-57
+            UInt128{ 0xFB158592BE068D2E, 0xEED6E2F0F0D56712 }, // 5^-56
+            UInt128{ 0x9CED737BB6C4183D, 0x55464DD69685606B }, // 5^-55
+            UInt128{ 0xC428D05AA4751E4C, 0xAA97E14C3C26B886 }, // 5^-54
+            UInt128{ 0xF53304714D9265DF, 0xD53DD99F4B3066A8 }, // 5^-53
+            UInt128{ 0x993FE2C6D07B7FAB, 0xE546A8038EFE4029 }, // 5^-52
+            UInt128{ 0xBF8FDB78849A5F96, 0xDE98520472BDD033 }, // 5^-51
+            UInt128{ 0xEF73D256A5C0F77C, 0x963E66858F6D4440 }, // 5^-50
+            UInt128{ 0x95A8637627989AAD, 0xDDE7001379A44AA8 }, // 5^-49
+            UInt128{ 0xBB127C53B17EC159, 0x5560C018580D5D52 }, // 5^-48
+            UInt128{ 0xE9D71B689DDE71AF, 0xAAB8F01E6E10B4A6 }, // 5^-47
+            UInt128{ 0x9226712162AB070D, 0xCAB3961304CA70E8 }, // 5^-46
+            UInt128{ 0xB6B00D69BB55C8D1, 0x3D607B97C5FD0D22 }, // 5^-45
+            UInt128{ 0xE45C10C42A2B3B05, 0x8CB89A7DB77C506A }, // 5^-44
+            UInt128{ 0x8EB98A7A9A5B04E3, 0x77F3608E92ADB242 }, // 5^-43
+            UInt128{ 0xB267ED1940F1C61C, 0x55F038B237591ED3 }, // 5^-42
+            UInt128{ 0xDF01E85F912E37A3, 0x6B6C46DEC52F6688 }, // 5^-41
+            UInt128{ 0x8B61313BBABCE2C6, 0x2323AC4B3B3DA015 }, // 5^-40
+            UInt128{ 0xAE397D8AA96C1B77, 0xABEC975E0A0D081A }, // 5^-39
+            UInt128{ 0xD9C7DCED53C72255, 0x96E7BD358C904A21 }, // 5^-38
+            UInt128{ 0x881CEA14545C7575, 0x7E50D64177DA2E54 }, // 5^-37
+            UInt128{ 0xAA242499697392D2, 0xDDE50BD1D5D0B9E9 }, // 5^-36
+            UInt128{ 0xD4AD2DBFC3D07787, 0x955E4EC64B44E864 }, // 5^-35
+            UInt128{ 0x84EC3C97DA624AB4, 0xBD5AF13BEF0B113E }, // 5^-34
+            UInt128{ 0xA6274BBDD0FADD61, 0xECB1AD8AEACDD58E }, // 5^-33
+            UInt128{ 0xCFB11EAD453994BA, 0x67DE18EDA5814AF2 }, // 5^-32
+            UInt128{ 0x81CEB32C4B43FCF4, 0x80EACF948770CED7 }, // 5^-31
+            UInt128{ 0xA2425FF75E14FC31, 0xA1258379A94D028D }, // 5^-30
+            UInt128{ 0xCAD2F7F5359A3B3E, 0x096EE45813A04330 }, // 5^-29
+            UInt128{ 0xFD87B5F28300CA0D, 0x8BCA9D6E188853FC }, // 5^-28
+            UInt128{ 0x9E74D1B791E07E48, 0x775EA264CF55347E }, // 5^-27
+            UInt128{ 0xC612062576589DDA, 0x95364AFE032A819E }, // 5^-26
+            UInt128{ 0xF79687AED3EEC551, 0x3A83DDBD83F52205 }, // 5^-25
+            UInt128{ 0x9ABE14CD44753B52, 0xC4926A9672793543 }, // 5^-24
+            UInt128{ 0xC16D9A0095928A27, 0x75B7053C0F178294 }, // 5^-23
+            UInt128{ 0xF1C90080BAF72CB1, 0x5324C68B12DD6339 }, // 5^-22
+            UInt128{ 0x971DA05074DA7BEE, 0xD3F6FC16EBCA5E04 }, // 5^-21
+            UInt128{ 0xBCE5086492111AEA, 0x88F4BB1CA6BCF585 }, // 5^-20
+            UInt128{ 0xEC1E4A7DB69561A5, 0x2B31E9E3D06C32E6 }, // 5^-19
+            UInt128{ 0x9392EE8E921D5D07, 0x3AFF322E62439FD0 }, // 5^-18
+            UInt128{ 0xB877AA3236A4B449, 0x09BEFEB9FAD487C3 }, // 5^-17
+            UInt128{ 0xE69594BEC44DE15B, 0x4C2EBE687989A9B4 }, // 5^-16
+            UInt128{ 0x901D7CF73AB0ACD9, 0x0F9D37014BF60A11 }, // 5^-15
+            UInt128{ 0xB424DC35095CD80F, 0x538484C19EF38C95 }, // 5^-14
+            UInt128{ 0xE12E13424BB40E13, 0x2865A5F206B06FBA }, // 5^-13
+            UInt128{ 0x8CBCCC096F5088CB, 0xF93F87B7442E45D4 }, // 5^-12
+            UInt128{ 0xAFEBFF0BCB24AAFE, 0xF78F69A51539D749 }, // 5^-11
+            UInt128{ 0xDBE6FECEBDEDD5BE, 0xB573440E5A884D1C }, // 5^-10
+            UInt128{ 0x89705F4136B4A597, 0x31680A88F8953031 }, // 5^-9
+            UInt128{ 0xABCC77118461CEFC, 0xFDC20D2B36BA7C3E }, // 5^-8
+            UInt128{ 0xD6BF94D5E57A42BC, 0x3D32907604691B4D }, // 5^-7
+            UInt128{ 0x8637BD05AF6C69B5, 0xA63F9A49C2C1B110 }, // 5^-6
+            UInt128{ 0xA7C5AC471B478423, 0x0FCF80DC33721D54 }, // 5^-5
+            UInt128{ 0xD1B71758E219652B, 0xD3C36113404EA4A9 }, // 5^-4
+            UInt128{ 0x83126E978D4FDF3B, 0x645A1CAC083126EA }, // 5^-3
+            UInt128{ 0xA3D70A3D70A3D70A, 0x3D70A3D70A3D70A4 }, // 5^-2
+            UInt128{ 0xCCCCCCCCCCCCCCCC, 0xCCCCCCCCCCCCCCCD }, // 5^-1
+            UInt128{ 0x8000000000000000, 0x0000000000000000 }, // 5^0
+            UInt128{ 0xA000000000000000, 0x0000000000000000 }, // 5^1
+            UInt128{ 0xC800000000000000, 0x0000000000000000 }, // 5^2
+            UInt128{ 0xFA00000000000000, 0x0000000000000000 }, // 5^3
+            UInt128{ 0x9C40000000000000, 0x0000000000000000 }, // 5^4
+            UInt128{ 0xC350000000000000, 0x0000000000000000 }, // 5^5
+            UInt128{ 0xF424000000000000, 0x0000000000000000 }, // 5^6
+            UInt128{ 0x9896800000000000, 0x0000000000000000 }, // 5^7
+            UInt128{ 0xBEBC200000000000, 0x0000000000000000 }, // 5^8
+            UInt128{ 0xEE6B280000000000, 0x0000000000000000 }, // 5^9
+            UInt128{ 0x9502F90000000000, 0x0000000000000000 }, // 5^10
+            UInt128{ 0xBA43B74000000000, 0x0000000000000000 }, // 5^11
+            UInt128{ 0xE8D4A51000000000, 0x0000000000000000 }, // 5^12
+            UInt128{ 0x9184E72A00000000, 0x0000000000000000 }, // 5^13
+            UInt128{ 0xB5E620F480000000, 0x0000000000000000 }, // 5^14
+            UInt128{ 0xE35FA931A0000000, 0x0000000000000000 }, // 5^15
+            UInt128{ 0x8E1BC9BF04000000, 0x0000000000000000 }, // 5^16
+            UInt128{ 0xB1A2BC2EC5000000, 0x0000000000000000 }, // 5^17
+            UInt128{ 0xDE0B6B3A76400000, 0x0000000000000000 }, // 5^18
+            UInt128{ 0x8AC7230489E80000, 0x0000000000000000 }, // 5^19
+            UInt128{ 0xAD78EBC5AC620000, 0x0000000000000000 }, // 5^20
+            UInt128{ 0xD8D726B7177A8000, 0x0000000000000000 }, // 5^21
+            UInt128{ 0x878678326EAC9000, 0x0000000000000000 }, // 5^22
+            UInt128{ 0xA968163F0A57B400, 0x0000000000000000 }, // 5^23
+            UInt128{ 0xD3C21BCECCEDA100, 0x0000000000000000 }, // 5^24
+            UInt128{ 0x84595161401484A0, 0x0000000000000000 }, // 5^25
+            UInt128{ 0xA56FA5B99019A5C8, 0x0000000000000000 }, // 5^26
+            UInt128{ 0xCECB8F27F4200F3A, 0x0000000000000000 }, // 5^27
+            UInt128{ 0x813F3978F8940984, 0x4000000000000000 }, // 5^28
+            UInt128{ 0xA18F07D736B90BE5, 0x5000000000000000 }, // 5^29
+            UInt128{ 0xC9F2C9CD04674EDE, 0xA400000000000000 }, // 5^30
+            UInt128{ 0xFC6F7C4045812296, 0x4D00000000000000 }, // 5^31
+            UInt128{ 0x9DC5ADA82B70B59D, 0xF020000000000000 }, // 5^32
+            UInt128{ 0xC5371912364CE305, 0x6C28000000000000 }, // 5^33
+            UInt128{ 0xF684DF56C3E01BC6, 0xC732000000000000 }, // 5^34
+            UInt128{ 0x9A130B963A6C115C, 0x3C7F400000000000 }, // 5^35
+            UInt128{ 0xC097CE7BC90715B3, 0x4B9F100000000000 }, // 5^36
+            UInt128{ 0xF0BDC21ABB48DB20, 0x1E86D40000000000 }, // 5^37
+            UInt128{ 0x96769950B50D88F4, 0x1314448000000000 }, // 5^38
+        };
+
+    static constexpr bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    static constexpr bool isEightDigits(std::uint64_t word)
+    {
+        return
+            ((word & 0xF0F0F0F0F0F0F0F0)
+                | (((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4))
+            == 0x3333333333333333;
+    }
+
+    static constexpr std::uint64_t parseEightDigits(std::uint64_t word)
+    {
+        constexpr auto mask = std::uint64_t{ 0x000000FF000000FF };
+        constexpr auto multiplier1 = std::uint64_t{ 0x000F424000000064 };
+        constexpr auto multiplier2 = std::uint64_t{ 0x0000271000000001 };
+
+        word -= 0x3030303030303030;
+        word = (word * 10) + (word >> 8);
+
+        return
+            (((word & mask) * multiplier1)
+                + (((word >> 16) & mask) * multiplier2))
+            >> 32;
+    }
+
+    static bool consumeEightDigits(
+        const char* cursor,
+        const char* end,
+        std::uint64_t& mantissa)
+    {
+        if (end - cursor < 8)
+        {
+            return false;
+        }
+
+        auto word = std::uint64_t{};
+        std::memcpy(&word, cursor, sizeof(word));
+        if (!isEightDigits(word))
+        {
+            return false;
+        }
+
+        mantissa = mantissa * 100000000 + parseEightDigits(word);
+
+        return true;
+    }
+
+    static constexpr std::int64_t parseExplicitExponent(
+        const char*& cursor,
+        const char* end)
+    {
+        if (cursor == end || (*cursor != 'e' && *cursor != 'E'))
+        {
+            return 0;
+        }
+
+        auto exponentCursor = cursor + 1;
+
+        auto negative = false;
+        if (exponentCursor != end
+            && (*exponentCursor == '-' || *exponentCursor == '+'))
+        {
+            negative = *exponentCursor == '-';
+            exponentCursor++;
+        }
+
+        if (exponentCursor == end || !isDigit(*exponentCursor))
+        {
+            return 0;
+        }
+
+        auto exponent = std::int64_t{};
+        while (exponentCursor != end && isDigit(*exponentCursor))
+        {
+            exponent =
+                std::min<std::int64_t>(
+                    exponent * 10 + (*exponentCursor - '0'),
+                    maximumExplicitExponent);
+            exponentCursor++;
+        }
+
+        cursor = exponentCursor;
+
+        return negative ? -exponent : exponent;
+    }
+
+    static constexpr bool parseDecimal(
+        const char*& cursor,
+        const char* end,
+        DecimalNumber& number)
+    {
+        if (cursor != end && (*cursor == '-' || *cursor == '+'))
+        {
+            number.negative = *cursor == '-';
+            cursor++;
+        }
+
+        const auto digitsBegin = cursor;
+        const char* decimalPoint = nullptr;
+
+        auto significantDigits = 0;
+        for (; cursor != end; cursor++)
+        {
+            if !consteval
+            {
+                if (significantDigits > 0
+                    && significantDigits + 8 <= maximumMantissaDigits
+                    && consumeEightDigits(cursor, end, number.mantissa))
+                {
+                    significantDigits += 8;
+                    cursor += 7;
+                    continue;
+                }
+            }
+
+            if (!isDigit(*cursor))
+            {
+                if (*cursor == '.' && !decimalPoint)
+                {
+                    decimalPoint = cursor;
+                    continue;
+                }
+
+                break;
+            }
+
+            if (significantDigits < maximumMantissaDigits)
+            {
+                number.mantissa =
+                    number.mantissa * 10
+                        + static_cast<std::uint64_t>(*cursor - '0');
+                significantDigits += number.mantissa != 0;
+            }
+            else
+            {
+                number.truncated |= *cursor != '0';
+                number.exponent++;
+            }
+        }
+
+        const auto fractionDigits =
+            decimalPoint ? std::int64_t{ cursor - decimalPoint - 1 } : 0;
+
+        if (cursor - digitsBegin == (decimalPoint ? 1 : 0))
+        {
+            return false;
+        }
+
+        number.digits =
+            std::string_view(
+                digitsBegin,
+                static_cast<size_t>(cursor - digitsBegin));
+
+        const auto explicitExponent = parseExplicitExponent(cursor, end);
+
+        number.exponent += explicitExponent - fractionDigits;
+        number.digitsExponent = explicitExponent - fractionDigits;
+
+        return true;
+    }
+
+    static constexpr UInt128 multiply(std::uint64_t a, std::uint64_t b)
+    {
+        const auto aLow = a & 0xFFFFFFFF;
+        const auto aHigh = a >> 32;
+        const auto bLow = b & 0xFFFFFFFF;
+        const auto bHigh = b >> 32;
+
+        const auto lowLow = aLow * bLow;
+        const auto lowHigh = aLow * bHigh;
+        const auto highLow = aHigh * bLow;
+        const auto highHigh = aHigh * bHigh;
+
+        const auto middle =
+            (lowLow >> 32) + (lowHigh & 0xFFFFFFFF) + (highLow & 0xFFFFFFFF);
+
+        return
+            UInt128
+            {
+                .high =
+                    highHigh
+                        + (lowHigh >> 32)
+                        + (highLow >> 32)
+                        + (middle >> 32),
+                .low = (middle << 32) | (lowLow & 0xFFFFFFFF)
+            };
+    }
+
+    static constexpr AdjustedMantissa computeFloat(
+        std::int64_t q,
+        std::uint64_t w)
+    {
+        if (w == 0 || q < smallestPowerOfTen)
+        {
+            return { .mantissa = 0, .power2 = 0 };
+        }
+
+        if (q > largestPowerOfTen)
+        {
+            return { .mantissa = 0, .power2 = infinitePower };
+        }
+
+        const auto leadingZeros = std::countl_zero(w);
+        w <<= leadingZeros;
+
+        const auto& powerOfFive =
+            powersOfFive[static_cast<size_t>(q - smallestPowerOfTen)];
+
+        constexpr auto precisionMask =
+            std::numeric_limits<std::uint64_t>::max() >> (mantissaBits + 3);
+
+        auto product = multiply(w, powerOfFive.high);
+        if ((product.high & precisionMask) == precisionMask)
+        {
+            const auto secondProduct = multiply(w, powerOfFive.low);
+
+            product.low += secondProduct.high;
+            if (secondProduct.high > product.low)
+            {
+                product.high++;
+            }
+        }
+
+        const auto upperBit = static_cast<int>(product.high >> 63);
+        const auto shift = upperBit + 64 - mantissaBits - 3;
+
+        auto result =
+            AdjustedMantissa
+            {
+                .mantissa = product.high >> shift,
+                .power2 =
+                    static_cast<std::int32_t>(
+                        (((152170 + 65536) * q) >> 16)
+                            + 63
+                            + upperBit
+                            - leadingZeros
+                            - minimumExponent)
+            };
+
+        if (result.power2 <= 0)
+        {
+            if (-result.power2 + 1 >= 64)
+            {
+                return { .mantissa = 0, .power2 = 0 };
+            }
+
+            result.mantissa >>= -result.power2 + 1;
+            result.mantissa += result.mantissa & 1;
+            result.mantissa >>= 1;
+            result.power2 =
+                result.mantissa < (std::uint64_t{ 1 } << mantissaBits) ? 0 : 1;
+
+            return result;
+        }
+
+        if (product.low <= 1
+            && q >= minimumRoundToEvenPower
+            && q <= maximumRoundToEvenPower
+            && (result.mantissa & 3) == 1
+            && (result.mantissa << shift) == product.high)
+        {
+            result.mantissa &= ~std::uint64_t{ 1 };
+        }
+
+        result.mantissa += result.mantissa & 1;
+        result.mantissa >>= 1;
+
+        if (result.mantissa >= (std::uint64_t{ 2 } << mantissaBits))
+        {
+            result.mantissa = std::uint64_t{ 1 } << mantissaBits;
+            result.power2++;
+        }
+
+        result.mantissa &= ~(std::uint64_t{ 1 } << mantissaBits);
+
+        if (result.power2 >= infinitePower)
+        {
+            return { .mantissa = 0, .power2 = infinitePower };
+        }
+
+        return result;
+    }
+
+    static constexpr AdjustedMantissa computeFloatExactly(
+        const DecimalNumber& number)
+    {
+        auto digits = BigInteger{};
+        auto digitCount = 0;
+        auto exponent = number.digitsExponent;
+        auto sticky = false;
+
+        for (const auto c : number.digits)
+        {
+            if (!isDigit(c) || (digitCount == 0 && c == '0'))
+            {
+                continue;
+            }
+
+            if (digitCount < maximumExactDigits)
+            {
+                digits.multiplyAdd(10, static_cast<std::uint32_t>(c - '0'));
+                digitCount++;
+            }
+            else
+            {
+                sticky |= c != '0';
+                exponent++;
+            }
+        }
+
+        if (sticky)
+        {
+            digits.multiplyAdd(10, 1);
+            exponent--;
+        }
+
+        auto numerator = digits;
+        auto denominator = BigInteger(1);
+        if (exponent >= 0)
+        {
+            numerator.multiplyByPowerOf(10, static_cast<size_t>(exponent));
+        }
+        else
+        {
+            denominator.multiplyByPowerOf(10, static_cast<size_t>(-exponent));
+        }
+
+        constexpr auto maximumScale = mantissaBits - minimumExponent;
+
+        auto remainder = BigInteger{};
+        const auto divideScaled =
+        [&](int scale)
+        {
+            auto scaledNumerator = numerator;
+            auto scaledDenominator = denominator;
+            if (scale >= 0)
+            {
+                scaledNumerator.shiftLeft(static_cast<size_t>(scale));
+            }
+            else
+            {
+                scaledDenominator.shiftLeft(static_cast<size_t>(-scale));
+            }
+
+            remainder = scaledNumerator;
+
+            return remainder.divideBy(scaledDenominator, mantissaBits + 3);
+        };
+
+        auto scale =
+            std::min(
+                mantissaBits + 1
+                    + static_cast<int>(denominator.getBitLength())
+                    - static_cast<int>(numerator.getBitLength()),
+                maximumScale);
+
+        auto quotient = divideScaled(scale);
+        if (quotient < (std::uint64_t{ 1 } << (mantissaBits + 1))
+            && scale < maximumScale)
+        {
+            scale++;
+            quotient = divideScaled(scale);
+        }
+
+        auto mantissa = quotient >> 1;
+        if ((quotient & 1) && (!remainder.isZero() || (mantissa & 1)))
+        {
+            mantissa++;
+        }
+
+        auto power2 = 1 - scale + mantissaBits - minimumExponent;
+        if (mantissa == (std::uint64_t{ 2 } << mantissaBits))
+        {
+            mantissa >>= 1;
+            power2++;
+        }
+
+        if (mantissa < (std::uint64_t{ 1 } << mantissaBits))
+        {
+            return { .mantissa = mantissa, .power2 = 0 };
+        }
+
+        if (power2 >= infinitePower)
+        {
+            return { .mantissa = 0, .power2 = infinitePower };
+        }
+
+        return
+            AdjustedMantissa
+            {
+                .mantissa = mantissa & ~(std::uint64_t{ 1 } << mantissaBits),
+                .power2 = power2
+            };
+    }
+
+    static constexpr float toFloat(const DecimalNumber& number)
+    {
+        if (!number.truncated
+            && number.exponent >= -maximumFastPathPower
+            && number.exponent <= maximumFastPathPower
+            && number.mantissa <= maximumFastPathMantissa)
+        {
+            const auto mantissa = static_cast<float>(number.mantissa);
+            const auto value =
+                number.exponent < 0
+                    ? mantissa
+                        / powersOfTen[static_cast<size_t>(-number.exponent)]
+                    : mantissa
+                        * powersOfTen[static_cast<size_t>(number.exponent)];
+
+            return number.negative ? -value : value;
+        }
+
+        auto adjustedMantissa = computeFloat(number.exponent, number.mantissa);
+        if (number.truncated
+            && adjustedMantissa
+                != computeFloat(number.exponent, number.mantissa + 1))
+        {
+            adjustedMantissa = computeFloatExactly(number);
+        }
+
+        const auto bits =
+            static_cast<std::uint32_t>(adjustedMantissa.mantissa)
+                | static_cast<std::uint32_t>(adjustedMantissa.power2)
+                    << mantissaBits
+                | static_cast<std::uint32_t>(number.negative) << 31;
+
+        return std::bit_cast<float>(bits);
+    }
+
+public:
+    static constexpr FloatParseResult parse(const char* begin, const char* end)
+    {
+        auto cursor = begin;
+        auto number = DecimalNumber{};
+
+        if (!parseDecimal(cursor, end, number))
+        {
+            return { .value = 0.0f, .next = begin };
+        }
+
+        return { .value = toFloat(number), .next = cursor };
+    }
+};
+
+constexpr float parseFloat(std::string_view str)
+{
+    return FloatParser::parse(str.data(), str.data() + str.size()).value;
+}
+} // namespace ctoAssetsRTIS
@@ -11,48 +11,10 @@
 #include <utility>
 
 #include "AutomaticDurationString.h"
+#include "ParseFloat.h"
 
 namespace ctoAssetsRTIS
 {
-constexpr float parseFloat(std::string_view str)
-{
-    int sign = 1;
-
-    if (!str.empty() && str[0] == '-')
-    {
-        sign = -1;
-        str.remove_prefix(1);
-    }
-
-    float result = 0.0f;
-
-    float divisor = 1.0f;
-    bool decimalEncountered = false;
-    for (auto c : str)
-    {
-        if (c == '.') {
-            decimalEncountered = true;
-            continue;
-        }
-
-        const int digit = c - '0';
-        if (digit < 0 || digit > 9) {
-            break;
-        }
-
-        if (decimalEncountered)
-        {
-            divisor *= 0.1f;
-            result += digit * divisor;
-            continue;
-        }
-
-        result = result * 10.0f + digit;
-    }
-
-    return result * sign;
-}
-
 template<auto _AutomaticDurationString>
 struct Sequence
 {
@@ -233,7 +195,8 @@ private:
                 }();
 
                 auto tokenOffset = size_t{};
-                constexpr auto tokenCount = result[0].size();
+                constexpr auto tokenCount =
+                    std::tuple_size<ResolvedResultType>::value;
                 for (auto j = size_t{}; j < tokenCount; j++)
                 {
                     const auto spaceOffset =
@@ -366,4 +329,37 @@ using ParseWavefrontMtl =
         MaterialLibraryData::value,
         WavefrontMtlSchema::Ruleset
     >;
+
+namespace SceneDescriptionSchema
+{
+    template<typename...>
+    using Placement = std::array<float, 9>;
+
+    template<
+        typename IdString,
+        typename StaticPlacements,
+        typename DynamicPlacements
+    >
+    struct ModelDirective
+    {
+        IdString id;
+        StaticPlacements staticPlacements;
+        DynamicPlacements dynamicPlacements;
+    };
+
+    using Ruleset =
+        Rule<
+            Sequence<"model"_ads>,
+            ModelDirective,
+            Rule<Sequence<"static"_ads>, Placement>,
+            Rule<Sequence<"dynamic"_ads>, Placement>
+        >;
+}
+
+template<typename SceneDescriptionData>
+using ParseSceneDescription =
+    ParseStructuredSequentialData<
+        SceneDescriptionData::value,
+        SceneDescriptionSchema::Ruleset
+    >;
 } // namespace ctoAssetsRTIS
@@ -0,0 +1,387 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <format>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ParseStructuredSequentialData.h"
+
+
+namespace ctoAssetsRTIS
+{
+template<typename TopLevelRule>
+class RuntimeParseStructuredSequentialData
+{
+private:
+    template<typename CurrentRule>
+    using SubRules =
+        typename std::remove_const<decltype(CurrentRule::subRules)>::type;
+
+    template<typename CurrentRule>
+    static constexpr auto subRulesCount =
+        std::tuple_size<SubRules<CurrentRule>>::value;
+
+    template<size_t Index, typename CurrentRule>
+    using NthSubRule =
+        typename std::tuple_element<Index, SubRules<CurrentRule>>::type;
+
+public:
+    template<typename CurrentRule, typename = SubRules<CurrentRule>>
+    struct LogicalBlock;
+
+    template<typename CurrentRule>
+    struct LogicalBlock<CurrentRule, std::tuple<>>
+    {
+        using Value = typename CurrentRule::template ResultType<void>;
+
+        std::vector<Value> values;
+    };
+
+    template<typename CurrentRule, typename... Rules>
+    struct LogicalBlock<CurrentRule, std::tuple<Rules...>>
+    {
+        struct Element
+        {
+            std::string_view id;
+            bool continuation;
+            std::tuple<LogicalBlock<Rules>...> fields;
+        };
+
+        std::vector<Element> elements;
+    };
+
+    using Result = LogicalBlock<TopLevelRule>;
+
+private:
+    template<typename CurrentRule>
+    static bool ownsLine(std::string_view line)
+    {
+        if (line.starts_with(CurrentRule::Sequence::view))
+        {
+            return true;
+        }
+
+        return
+        [&]<size_t... Indices>(std::index_sequence<Indices...>)
+        {
+            return (ownsLine<NthSubRule<Indices, CurrentRule>>(line) || ...);
+        }(std::make_index_sequence<subRulesCount<CurrentRule>>{});
+    }
+
+    template<typename Value>
+    static Value parseValue(std::string_view arguments)
+    {
+        const auto isSeparator =
+        [](char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r';
+        };
+
+        auto value = Value{};
+
+        auto cursor = arguments.data();
+        const auto end = cursor + arguments.size();
+        for (auto& element : value)
+        {
+            while (cursor != end && isSeparator(*cursor))
+            {
+                cursor++;
+            }
+
+            const auto next =
+            [&]
+            {
+                using Element = std::remove_cvref_t<decltype(element)>;
+                if constexpr (std::is_same_v<Element, float>)
+                {
+                    const auto result = FloatParser::parse(cursor, end);
+                    element = result.value;
+                    return result.next;
+                }
+                else
+                {
+                    const auto result = std::from_chars(cursor, end, element);
+                    return
+                        result.ec == std::errc{} ? result.ptr : cursor;
+                }
+            }();
+
+            if (next == cursor)
+            {
+                throw std::runtime_error(
+                    std::format("Malformed element: {}", arguments));
+            }
+
+            cursor = next;
+            while (cursor != end && !isSeparator(*cursor))
+            {
+                cursor++;
+            }
+        }
+
+        return value;
+    }
+
+    static std::string_view parseId(std::string_view arguments)
+    {
+        const auto begin = arguments.find_first_not_of(" \t");
+        if (begin == arguments.npos)
+        {
+            return {};
+        }
+
+        const auto end = arguments.find_last_not_of(" \t\r");
+        return arguments.substr(begin, end - begin + 1);
+    }
+
+    template<typename CurrentRule>
+    static void consumeLine(
+        LogicalBlock<CurrentRule>& block,
+        std::string_view line)
+    {
+        using Sequence = CurrentRule::Sequence;
+
+        if constexpr (subRulesCount<CurrentRule> == 0)
+        {
+            using Value = LogicalBlock<CurrentRule>::Value;
+
+            block.values.push_back(
+                parseValue<Value>(line.substr(Sequence::view.size())));
+        }
+        else
+        {
+            if (line.starts_with(Sequence::view))
+            {
+                block.elements.push_back({
+                    .id = parseId(line.substr(Sequence::view.size())),
+                    .continuation = false,
+                    .fields = {}
+                });
+                return;
+            }
+
+            if (block.elements.empty())
+            {
+                block.elements.push_back({
+                    .id = {},
+                    .continuation = true,
+                    .fields = {}
+                });
+            }
+
+            auto& fields = block.elements.back().fields;
+            [&]<size_t... Indices>(std::index_sequence<Indices...>)
+            {
+                ((ownsLine<NthSubRule<Indices, CurrentRule>>(line)
+                    && (consumeLine(std::get<Indices>(fields), line), true))
+                || ...);
+            }(std::make_index_sequence<subRulesCount<CurrentRule>>{});
+        }
+    }
+
+    template<typename CurrentRule>
+    static void merge(
+        LogicalBlock<CurrentRule>& into,
+        LogicalBlock<CurrentRule>& from)
+    {
+        if constexpr (subRulesCount<CurrentRule> == 0)
+        {
+            into.values.insert(
+                into.values.end(),
+                from.values.begin(),
+                from.values.end());
+        }
+        else
+        {
+            auto begin = from.elements.begin();
+            if (begin != from.elements.end()
+                && begin->continuation
+                && !into.elements.empty())
+            {
+                auto& intoFields = into.elements.back().fields;
+                auto& fromFields = begin->fields;
+
+                [&]<size_t... Indices>(std::index_sequence<Indices...>)
+                {
+                    (merge(
+                        std::get<Indices>(intoFields),
+                        std::get<Indices>(fromFields)), ...);
+                }(std::make_index_sequence<subRulesCount<CurrentRule>>{});
+
+                begin++;
+            }
+
+            into.elements.insert(
+                into.elements.end(),
+                std::make_move_iterator(begin),
+                std::make_move_iterator(from.elements.end()));
+        }
+    }
+
+    template<typename CurrentRule>
+    static void discardDetachedElements(LogicalBlock<CurrentRule>& block)
+    {
+        if constexpr (subRulesCount<CurrentRule> > 0)
+        {
+            std::erase_if(
+                block.elements,
+                [](const auto& element) { return element.continuation; });
+
+            for (auto& element : block.elements)
+            {
+                std::apply(
+                    [](auto&... fields)
+                    {
+                        (discardDetachedElements(fields), ...);
+                    },
+                    element.fields);
+            }
+        }
+    }
+
+    static void parseChunk(Result& result, std::string_view chunk)
+    {
+        while (!chunk.empty())
+        {
+            const auto newLineOffset = chunk.find('\n');
+            const auto line = chunk.substr(0, newLineOffset);
+
+            if (ownsLine<TopLevelRule>(line))
+            {
+                consumeLine(result, line);
+            }
+
+            chunk.remove_prefix(
+                newLineOffset == chunk.npos
+                    ? chunk.size()
+                    : newLineOffset + 1);
+        }
+    }
+
+    static auto splitAtLineBoundaries(std::string_view data)
+    {
+        static constexpr auto minimumChunkSizeBytes = size_t{ 1 << 20 };
+
+        const auto chunkCount =
+            std::clamp<size_t>(
+                data.size() / minimumChunkSizeBytes,
+                1,
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+                std::max(std::thread::hardware_concurrency(), 1u));
+#else
+                1);
+#endif
+
+        auto chunks = std::vector<std::string_view>();
+        chunks.reserve(chunkCount);
+
+        const auto chunkSize = data.size() / chunkCount;
+        for (auto i = size_t{}; i < chunkCount && !data.empty(); i++)
+        {
+            const auto newLineOffset =
+                i + 1 == chunkCount
+                    ? data.npos
+                    : data.find('\n', chunkSize);
+
+            const auto length =
+                newLineOffset == data.npos
+                    ? data.size()
+                    : newLineOffset + 1;
+
+            chunks.push_back(data.substr(0, length));
+            data.remove_prefix(length);
+        }
+
+        return chunks;
+    }
+
+public:
+    static Result parse(std::string_view data)
+    {
+        const auto chunks = splitAtLineBoundaries(data);
+
+        auto chunkResults = std::vector<Result>(chunks.size());
+        auto chunkExceptions =
+            std::vector<std::exception_ptr>(chunks.size());
+
+        const auto parseNthChunk =
+        [&](size_t index)
+        {
+            try
+            {
+                parseChunk(chunkResults[index], chunks[index]);
+            }
+            catch (...)
+            {
+                chunkExceptions[index] = std::current_exception();
+            }
+        };
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+        {
+            auto workers = std::vector<std::thread>();
+            workers.reserve(chunks.size());
+
+            for (auto i = size_t{ 1 }; i < chunks.size(); i++)
+            {
+                workers.emplace_back(parseNthChunk, i);
+            }
+
+            if (!chunks.empty())
+            {
+                parseNthChunk(0);
+            }
+
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+        }
+#else
+        for (auto i = size_t{}; i < chunks.size(); i++)
+        {
+            parseNthChunk(i);
+        }
+#endif
+
+        for (const auto& exception : chunkExceptions)
+        {
+            if (exception)
+            {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        auto result = Result{};
+        for (auto& chunkResult : chunkResults)
+        {
+            merge(result, chunkResult);
+        }
+
+        discardDetachedElements(result);
+
+        return result;
+    }
+};
+
+using RuntimeParseWavefrontObj =
+    RuntimeParseStructuredSequentialData<WavefrontObjSchema::Ruleset>;
+
+using RuntimeParseWavefrontMtl =
+    RuntimeParseStructuredSequentialData<WavefrontMtlSchema::Ruleset>;
+} // namespace ctoAssetsRTIS
@@ -0,0 +1,261 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+
+namespace ctoAssetsRTIS
+{
+// Streams of 32-bit words are split into blocks of elements. Per block and
+// per component, each word is delta coded against the previous element and
+// zigzag mapped, then each of its four byte lanes is packed at 0, 2, 4 or 8
+// bits per value, chosen by a 2-bit code in a one byte block header. The
+// last block packs only the elements that remain.
+template<typename Word>
+struct EncodedStream
+{
+    std::span<const std::uint8_t> bytes;
+    size_t wordCount;
+    size_t stride;
+};
+
+class StreamEncoding
+{
+private:
+    static constexpr auto blockSize = size_t{ 16 };
+    static constexpr auto laneCount = size_t{ 4 };
+    static constexpr auto laneBits = std::array<size_t, 4>{ 0, 2, 4, 8 };
+
+    using Block = std::array<std::uint32_t, blockSize>;
+
+    static constexpr std::uint32_t zigzag(std::uint32_t delta)
+    {
+        return (delta << 1) ^ (0u - (delta >> 31));
+    }
+
+    static constexpr std::uint32_t unzigzag(std::uint32_t value)
+    {
+        return (value >> 1) ^ (0u - (value & 1));
+    }
+
+    template<typename Word>
+    static constexpr std::uint32_t readWord(
+        std::span<const Word> words,
+        size_t element,
+        size_t component,
+        size_t stride)
+    {
+        return
+            std::bit_cast<std::uint32_t>(words[element * stride + component]);
+    }
+
+    static constexpr size_t getLaneSize(size_t bits, size_t count)
+    {
+        return (bits * count + 7) / 8;
+    }
+
+    template<size_t Bits>
+    static constexpr void unpackLane(
+        const std::uint8_t* laneBytes,
+        Block& block,
+        size_t lane,
+        size_t count)
+    {
+        constexpr auto mask = std::uint32_t{ (1u << Bits) - 1 };
+
+        for (auto i = size_t{}; i < count; i++)
+        {
+            const auto byte = laneBytes[i * Bits / 8];
+            const auto value = (byte >> (i * Bits % 8)) & mask;
+
+            block[i] |= value << (lane * 8);
+        }
+    }
+
+    template<typename Word>
+    static constexpr void encodeBlocks(
+        std::span<const Word> words,
+        size_t stride,
+        auto emit)
+    {
+        const auto elementCount = words.size() / stride;
+
+        for (auto first = size_t{}; first < elementCount; first += blockSize)
+        {
+            const auto count = std::min(blockSize, elementCount - first);
+
+            for (auto component = size_t{}; component < stride; component++)
+            {
+                auto block = Block{};
+                for (auto i = size_t{}; i < count; i++)
+                {
+                    const auto element = first + i;
+                    const auto previous =
+                        element == 0
+                            ? std::uint32_t{}
+                            : readWord(words, element - 1, component, stride);
+
+                    block[i] =
+                        zigzag(
+                            readWord(words, element, component, stride)
+                                - previous);
+                }
+
+                auto codes = std::array<size_t, laneCount>{};
+                auto header = std::uint8_t{};
+                for (auto lane = size_t{}; lane < laneCount; lane++)
+                {
+                    auto maximum = std::uint32_t{};
+                    for (const auto value : block)
+                    {
+                        maximum =
+                            std::max(maximum, (value >> (lane * 8)) & 0xff);
+                    }
+
+                    while (maximum >= (1u << laneBits[codes[lane]]))
+                    {
+                        codes[lane]++;
+                    }
+
+                    header |=
+                        static_cast<std::uint8_t>(codes[lane] << (lane * 2));
+                }
+
+                emit(header);
+
+                for (auto lane = size_t{}; lane < laneCount; lane++)
+                {
+                    const auto bits = laneBits[codes[lane]];
+                    if (bits == 0)
+                    {
+                        continue;
+                    }
+
+                    for (auto i = size_t{}; i < count; i += 8 / bits)
+                    {
+                        auto byte = std::uint8_t{};
+                        for (auto j = size_t{}; j < 8 / bits; j++)
+                        {
+                            const auto value =
+                                (block[i + j] >> (lane * 8)) & 0xff;
+
+                            byte |=
+                                static_cast<std::uint8_t>(value << (j * bits));
+                        }
+
+                        emit(byte);
+                    }
+                }
+            }
+        }
+    }
+
+public:
+    template<typename Word, size_t WordCount>
+    static constexpr size_t getEncodedSize(
+        const std::array<Word, WordCount>& words,
+        size_t stride)
+    {
+        auto size = size_t{};
+        encodeBlocks(
+            std::span<const Word>(words),
+            stride,
+            [&](std::uint8_t) { size++; });
+
+        return size;
+    }
+
+    template<size_t EncodedSize, typename Word, size_t WordCount>
+    static constexpr auto encode(
+        const std::array<Word, WordCount>& words,
+        size_t stride)
+    {
+        auto result = std::array<std::uint8_t, EncodedSize>{};
+
+        auto offset = size_t{};
+        encodeBlocks(
+            std::span<const Word>(words),
+            stride,
+            [&](std::uint8_t byte) { result[offset++] = byte; });
+
+        return result;
+    }
+
+    template<typename Word>
+    static constexpr void decode(
+        const EncodedStream<Word>& encodedStream,
+        std::span<Word> words)
+    {
+        const auto stride = encodedStream.stride;
+        const auto elementCount = words.size() / stride;
+
+        auto cursor = encodedStream.bytes.begin();
+        const auto end = encodedStream.bytes.end();
+
+        for (auto first = size_t{}; first < elementCount; first += blockSize)
+        {
+            const auto count = std::min(blockSize, elementCount - first);
+
+            for (auto component = size_t{}; component < stride; component++)
+            {
+                if (cursor == end)
+                {
+                    throw std::runtime_error("Truncated encoded stream");
+                }
+
+                const auto header = *cursor++;
+
+                auto block = Block{};
+                for (auto lane = size_t{}; lane < laneCount; lane++)
+                {
+                    const auto code = (header >> (lane * 2)) & 3;
+                    const auto laneSize = getLaneSize(laneBits[code], count);
+
+                    if (static_cast<size_t>(end - cursor) < laneSize)
+                    {
+                        throw std::runtime_error("Truncated encoded stream");
+                    }
+
+                    switch (code)
+                    {
+                        case 1:
+                            unpackLane<2>(&*cursor, block, lane, count);
+                            break;
+                        case 2:
+                            unpackLane<4>(&*cursor, block, lane, count);
+                            break;
+                        case 3:
+                            unpackLane<8>(&*cursor, block, lane, count);
+                            break;
+                    }
+
+                    cursor += laneSize;
+                }
+
+                auto previous =
+                    first == 0
+                        ? std::uint32_t{}
+                        : readWord<Word>(words, first - 1, component, stride);
+
+                for (auto i = size_t{}; i < count; i++)
+                {
+                    previous += unzigzag(block[i]);
+                    words[(first + i) * stride + component] =
+                        std::bit_cast<Word>(previous);
+                }
+            }
+        }
+    }
+};
+} // namespace ctoAssetsRTIS
@@ -0,0 +1,151 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+namespace ctoAssetsRTIS
+{
+// Counts durations in fixed memory with bounded relative error, in the
+// manner of HdrHistogram. Durations are kept in whole microseconds: below
+// 2^subBucketBits each value has its own bucket, and above it every power
+// of two is split into 2^(subBucketBits - 1) buckets, so a bucket is never
+// wider than 1/128 of the values it holds. The buckets are allocated once,
+// on construction, and recording never allocates.
+class DurationHistogram
+{
+public:
+    void record(double milliseconds)
+    {
+        // Clamped as a double, which holds maximumMicroseconds exactly; as a
+        // float it would round up past the last bucket.
+        const auto microseconds =
+            static_cast<std::uint32_t>(
+                std::clamp(
+                    std::round(milliseconds * 1000.0),
+                    0.0,
+                    static_cast<double>(maximumMicroseconds)));
+
+        this->counts[getBucket(microseconds)]++;
+        this->count++;
+        this->maximum = std::max(this->maximum, microseconds);
+    }
+
+    // The largest duration at or below which the given percentage of
+    // recorded durations fall, to bucket precision, in milliseconds.
+    float getPercentile(float percentage) const
+    {
+        if (this->count == 0)
+        {
+            return 0.0f;
+        }
+
+        const auto rank =
+            std::max(
+                static_cast<std::uint64_t>(
+                    std::ceil(
+                        static_cast<double>(this->count)
+                            * std::clamp(percentage, 0.0f, 100.0f)
+                            / 100.0)),
+                std::uint64_t{ 1 });
+
+        auto cumulativeCount = std::uint64_t{};
+        for (auto bucket = size_t{}; bucket < bucketCount; bucket++)
+        {
+            cumulativeCount += this->counts[bucket];
+            if (cumulativeCount >= rank)
+            {
+                return
+                    static_cast<float>(
+                        std::min(getBucketUpperBound(bucket), this->maximum))
+                        / 1000.0f;
+            }
+        }
+
+        return this->getMaximum();
+    }
+
+    float getMaximum() const
+    {
+        return static_cast<float>(this->maximum) / 1000.0f;
+    }
+
+    std::uint64_t getCount() const
+    {
+        return this->count;
+    }
+
+    void reset()
+    {
+        std::fill(this->counts.begin(), this->counts.end(), 0);
+        this->count = 0;
+        this->maximum = 0;
+    }
+
+private:
+    static constexpr auto subBucketBits = 8;
+    static constexpr auto subBucketCount = std::uint32_t{ 1 } << subBucketBits;
+    static constexpr auto halfSubBucketCount = subBucketCount / 2;
+
+    static constexpr auto maximumMicroseconds =
+        std::numeric_limits<std::uint32_t>::max() / 2;
+
+    static constexpr auto bucketCount =
+        size_t{ subBucketCount }
+            + (std::bit_width(maximumMicroseconds) - subBucketBits)
+                * size_t{ halfSubBucketCount };
+
+    static constexpr size_t getBucket(std::uint32_t microseconds)
+    {
+        if (microseconds < subBucketCount)
+        {
+            return microseconds;
+        }
+
+        const auto magnitude = std::bit_width(microseconds) - 1;
+        const auto subBucket =
+            microseconds >> (magnitude - subBucketBits + 1);
+
+        return
+            subBucketCount
+                + static_cast<size_t>(magnitude - subBucketBits)
+                    * halfSubBucketCount
+                + (subBucket - halfSubBucketCount);
+    }
+
+    static constexpr std::uint32_t getBucketUpperBound(size_t bucket)
+    {
+        if (bucket < subBucketCount)
+        {
+            return static_cast<std::uint32_t>(bucket);
+        }
+
+        const auto magnitude =
+            static_cast<int>((bucket - subBucketCount) / halfSubBucketCount)
+                + subBucketBits;
+        const auto subBucket =
+            static_cast<std::uint32_t>(
+                (bucket - subBucketCount) % halfSubBucketCount
+                    + halfSubBucketCount);
+        const auto shift = magnitude - subBucketBits + 1;
+
+        return ((subBucket + 1) << shift) - 1;
+    }
+
+    std::vector<std::uint32_t> counts =
+        std::vector<std::uint32_t>(bucketCount);
+    std::uint64_t count = 0;
+    std::uint32_t maximum = 0;
+};
+} // namespace ctoAssetsRTIS
@@ -0,0 +1,565 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+namespace ctoAssetsRTIS
+{
+// Bounding volume hierarchy over a fixed set of moving objects, one object
+// per leaf. Moved objects only refit their ancestors' boxes, which keeps
+// updates proportional to the number of moved objects but lets the tree's
+// quality decay; once its surface area cost grows past rebuildThreshold
+// times the cost after the last build, the tree is rebuilt from a snapshot
+// of the object boxes on a background thread and swapped in when ready.
+class DynamicAabbTree
+{
+public:
+    static constexpr auto stackSize = size_t{ 64 };
+
+    struct Box
+    {
+        glm::vec3 minimum;
+        glm::vec3 maximum;
+
+        static Box merge(const Box& left, const Box& right)
+        {
+            return
+                Box
+                {
+                    .minimum = glm::min(left.minimum, right.minimum),
+                    .maximum = glm::max(left.maximum, right.maximum)
+                };
+        }
+
+        float getHalfArea() const
+        {
+            const auto extent = this->maximum - this->minimum;
+
+            return
+                extent.x * extent.y + extent.y * extent.z
+                    + extent.z * extent.x;
+        }
+
+        bool overlaps(const Box& other) const
+        {
+            for (auto axis = 0; axis < 3; axis++)
+            {
+                if (this->minimum[axis] > other.maximum[axis]
+                    || this->maximum[axis] < other.minimum[axis])
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Bounds of the box after an affine transformation.
+        Box transformed(const glm::mat4& matrix) const
+        {
+            const auto center = (this->minimum + this->maximum) * 0.5f;
+            const auto halfExtent = (this->maximum - this->minimum) * 0.5f;
+
+            auto transformedCenter = glm::vec3(matrix[3]);
+            auto transformedHalfExtent = glm::vec3(0.0f);
+            for (auto column = 0; column < 3; column++)
+            {
+                for (auto row = 0; row < 3; row++)
+                {
+                    transformedCenter[row] +=
+                        matrix[column][row] * center[column];
+                    transformedHalfExtent[row] +=
+                        std::abs(matrix[column][row]) * halfExtent[column];
+                }
+            }
+
+            return
+                Box
+                {
+                    .minimum = transformedCenter - transformedHalfExtent,
+                    .maximum = transformedCenter + transformedHalfExtent
+                };
+        }
+    };
+
+    // Planes face inward, extracted from a view-projection matrix.
+    struct Frustum
+    {
+        std::array<glm::vec4, 6> planes;
+
+        static Frustum fromMatrix(const glm::mat4& viewProjection)
+        {
+            const auto getRow =
+            [&](int row)
+            {
+                return
+                    glm::vec4(
+                        viewProjection[0][row],
+                        viewProjection[1][row],
+                        viewProjection[2][row],
+                        viewProjection[3][row]);
+            };
+
+            const auto w = getRow(3);
+
+            return
+                Frustum
+                {
+                    .planes =
+                    {
+                        w + getRow(0),
+                        w - getRow(0),
+                        w + getRow(1),
+                        w - getRow(1),
+                        w + getRow(2),
+                        w - getRow(2)
+                    }
+                };
+        }
+
+        // Conservative: boxes near the frustum's corners may pass.
+        bool overlaps(const Box& box) const
+        {
+            for (const auto& plane : this->planes)
+            {
+                const auto farthestCorner =
+                    glm::vec3(
+                        plane.x >= 0.0f ? box.maximum.x : box.minimum.x,
+                        plane.y >= 0.0f ? box.maximum.y : box.minimum.y,
+                        plane.z >= 0.0f ? box.maximum.z : box.minimum.z);
+
+                if (glm::dot(glm::vec3(plane), farthestCorner) + plane.w < 0.0f)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    struct Configuration
+    {
+        float rebuildThreshold;
+    };
+    DynamicAabbTree(Configuration configuration)
+    : rebuildThreshold{ configuration.rebuildThreshold }
+    {
+        if (this->rebuildThreshold < 1.0f)
+        {
+            throw std::invalid_argument(
+                "rebuildThreshold must be at least 1");
+        }
+    }
+
+    DynamicAabbTree(const DynamicAabbTree&) = delete;
+    DynamicAabbTree(DynamicAabbTree&&) = delete;
+    DynamicAabbTree& operator=(const DynamicAabbTree&) = delete;
+
+    // Replaces the indexed objects, building synchronously. Objects are
+    // identified by their index in bounds.
+    void reset(std::span<const Box> bounds)
+    {
+        this->waitForRebuild();
+
+        this->objectBounds.assign(bounds.begin(), bounds.end());
+        this->install(build(this->objectBounds));
+    }
+
+    void setBounds(size_t object, const Box& bounds)
+    {
+        this->objectBounds[object] = bounds;
+
+        for (auto node = this->leafNodes[object];
+            node != noNode && !this->dirtyFlags[node];
+            node = this->nodes[node].parent)
+        {
+            this->dirtyFlags[node] = true;
+            this->dirtyNodes.push_back(node);
+        }
+    }
+
+    // Refits the boxes above objects moved since the last update, and
+    // starts or completes a background rebuild.
+    void update()
+    {
+        if (this->pendingRebuild.valid()
+            && this->pendingRebuild.wait_for(std::chrono::seconds(0))
+                == std::future_status::ready)
+        {
+            this->install(this->pendingRebuild.get());
+            return;
+        }
+
+        // Parents precede their children, so descending order refits
+        // children first.
+        std::sort(
+            this->dirtyNodes.begin(),
+            this->dirtyNodes.end(),
+            std::greater<>());
+
+        for (const auto node : this->dirtyNodes)
+        {
+            this->dirtyFlags[node] = false;
+            this->refit(node);
+        }
+        this->dirtyNodes.clear();
+
+        if (this->nodes.empty()
+            || this->pendingRebuild.valid()
+            || this->getCost() <= this->builtCost * this->rebuildThreshold)
+        {
+            return;
+        }
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+        this->pendingRebuild =
+            std::async(
+                std::launch::async,
+                [objectBounds = this->objectBounds]
+                {
+                    return build(objectBounds);
+                });
+#else
+        this->install(build(this->objectBounds));
+#endif
+    }
+
+    template<typename Visitor>
+    void queryFrustum(const Frustum& frustum, Visitor&& visitor) const
+    {
+        this->query(
+            [&](const Box& box)
+            {
+                return frustum.overlaps(box);
+            },
+            visitor);
+    }
+
+    template<typename Visitor>
+    void queryBox(const Box& bounds, Visitor&& visitor) const
+    {
+        this->query(
+            [&](const Box& box)
+            {
+                return bounds.overlaps(box);
+            },
+            visitor);
+    }
+
+    // Visits objects whose boxes the ray enters within maximumDistance, in
+    // units of the direction's length.
+    template<typename Visitor>
+    void queryRay(
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maximumDistance,
+        Visitor&& visitor) const
+    {
+        const auto inverseDirection = 1.0f / direction;
+
+        this->query(
+            [&](const Box& box)
+            {
+                auto nearDistance = 0.0f;
+                auto farDistance = maximumDistance;
+                for (auto axis = 0; axis < 3; axis++)
+                {
+                    auto entry =
+                        (box.minimum[axis] - origin[axis])
+                            * inverseDirection[axis];
+                    auto exit =
+                        (box.maximum[axis] - origin[axis])
+                            * inverseDirection[axis];
+                    if (entry > exit)
+                    {
+                        std::swap(entry, exit);
+                    }
+
+                    nearDistance = entry > nearDistance ? entry : nearDistance;
+                    farDistance = exit < farDistance ? exit : farDistance;
+                }
+
+                return nearDistance <= farDistance;
+            },
+            visitor);
+    }
+
+    size_t size() const
+    {
+        return this->objectBounds.size();
+    }
+
+    bool isRebuilding() const
+    {
+        return this->pendingRebuild.valid();
+    }
+
+private:
+    static constexpr auto noNode = std::numeric_limits<std::uint32_t>::max();
+
+    // Interior nodes have their two children at firstChild and
+    // firstChild + 1; leaves hold one object.
+    struct Node
+    {
+        Box bounds = {};
+        std::uint32_t parent = noNode;
+        std::uint32_t firstChild = 0;
+        std::uint32_t object = noNode;
+    };
+
+    // Median split on the longest axis of the object centers.
+    static std::vector<Node> build(const std::vector<Box>& bounds)
+    {
+        struct PendingNode
+        {
+            std::uint32_t node;
+            size_t first;
+            size_t count;
+        };
+
+        auto result = std::vector<Node>();
+        if (bounds.empty())
+        {
+            return result;
+        }
+
+        result.reserve(bounds.size() * 2 - 1);
+
+        auto objects = std::vector<std::uint32_t>(bounds.size());
+        for (auto i = size_t{}; i < objects.size(); i++)
+        {
+            objects[i] = static_cast<std::uint32_t>(i);
+        }
+
+        const auto getCenter =
+        [&](std::uint32_t object)
+        {
+            return (bounds[object].minimum + bounds[object].maximum) * 0.5f;
+        };
+
+        auto pendingNodes = std::vector<PendingNode>();
+        result.emplace_back();
+        pendingNodes.push_back({
+            .node = 0,
+            .first = 0,
+            .count = objects.size()
+        });
+
+        while (!pendingNodes.empty())
+        {
+            const auto [node, first, count] = pendingNodes.back();
+            pendingNodes.pop_back();
+
+            if (count == 1)
+            {
+                result[node].bounds = bounds[objects[first]];
+                result[node].object = objects[first];
+                continue;
+            }
+
+            auto centerMinimum = getCenter(objects[first]);
+            auto centerMaximum = centerMinimum;
+            for (auto i = first + 1; i < first + count; i++)
+            {
+                centerMinimum = glm::min(centerMinimum, getCenter(objects[i]));
+                centerMaximum = glm::max(centerMaximum, getCenter(objects[i]));
+            }
+
+            const auto extent = centerMaximum - centerMinimum;
+            const auto axis =
+                extent.x >= extent.y && extent.x >= extent.z
+                    ? 0
+                    : extent.y >= extent.z ? 1 : 2;
+
+            const auto half = count / 2;
+            std::nth_element(
+                objects.begin() + first,
+                objects.begin() + first + half,
+                objects.begin() + first + count,
+                [&](std::uint32_t left, std::uint32_t right)
+                {
+                    return getCenter(left)[axis] < getCenter(right)[axis];
+                });
+
+            const auto firstChild = static_cast<std::uint32_t>(result.size());
+            result[node].firstChild = firstChild;
+            result.push_back({ .parent = node });
+            result.push_back({ .parent = node });
+
+            pendingNodes.push_back({
+                .node = firstChild + 1,
+                .first = first + half,
+                .count = count - half
+            });
+            pendingNodes.push_back({
+                .node = firstChild,
+                .first = first,
+                .count = half
+            });
+        }
+
+        // Interior boxes, children first.
+        for (auto node = result.size(); node-- > 0;)
+        {
+            if (result[node].object == noNode)
+            {
+                const auto firstChild = result[node].firstChild;
+                result[node].bounds =
+                    Box::merge(
+                        result[firstChild].bounds,
+                        result[firstChild + 1].bounds);
+            }
+        }
+
+        return result;
+    }
+
+    // Objects may have moved since the snapshot the nodes were built from,
+    // so every box is refit from the current object bounds.
+    void install(std::vector<Node> nodes)
+    {
+        this->nodes = std::move(nodes);
+        this->leafNodes.assign(this->objectBounds.size(), noNode);
+        this->dirtyFlags.assign(this->nodes.size(), false);
+        this->dirtyNodes.clear();
+        this->halfAreaSum = 0.0f;
+
+        for (auto node = this->nodes.size(); node-- > 0;)
+        {
+            const auto object = this->nodes[node].object;
+            if (object != noNode)
+            {
+                this->leafNodes[object] = static_cast<std::uint32_t>(node);
+            }
+
+            this->refit(node);
+        }
+
+        // An empty tree, as when no object has a bounding volume hierarchy,
+        // never rebuilds.
+        if (this->nodes.empty())
+        {
+            this->builtCost = 0.0f;
+            return;
+        }
+
+        this->builtCost = this->getCost();
+    }
+
+    void refit(size_t node)
+    {
+        auto& bounds = this->nodes[node].bounds;
+
+        const auto object = this->nodes[node].object;
+        if (object != noNode)
+        {
+            bounds = this->objectBounds[object];
+            return;
+        }
+
+        this->halfAreaSum -= bounds.getHalfArea();
+
+        const auto firstChild = this->nodes[node].firstChild;
+        bounds =
+            Box::merge(
+                this->nodes[firstChild].bounds,
+                this->nodes[firstChild + 1].bounds);
+
+        this->halfAreaSum += bounds.getHalfArea();
+    }
+
+    // Surface area heuristic cost of the interior nodes relative to the
+    // root's, which is the expected number of interior boxes a random ray
+    // through the root tests.
+    float getCost() const
+    {
+        if (this->nodes.empty())
+        {
+            return 0.0f;
+        }
+
+        const auto rootHalfArea = this->nodes[0].bounds.getHalfArea();
+
+        return
+            rootHalfArea > 0.0f
+                ? this->halfAreaSum / rootHalfArea
+                : 0.0f;
+    }
+
+    template<typename Overlaps, typename Visitor>
+    void query(Overlaps overlaps, Visitor& visitor) const
+    {
+        if (this->nodes.empty() || !overlaps(this->nodes[0].bounds))
+        {
+            return;
+        }
+
+        auto pendingNodes = std::array<std::uint32_t, stackSize>{};
+        auto pendingCount = size_t{};
+        pendingNodes[pendingCount++] = 0;
+
+        while (pendingCount > 0)
+        {
+            const auto& node = this->nodes[pendingNodes[--pendingCount]];
+            if (node.object != noNode)
+            {
+                visitor(static_cast<size_t>(node.object));
+                continue;
+            }
+
+            for (auto child = node.firstChild; child < node.firstChild + 2;
+                child++)
+            {
+                if (overlaps(this->nodes[child].bounds))
+                {
+                    pendingNodes[pendingCount++] = child;
+                }
+            }
+        }
+    }
+
+    void waitForRebuild()
+    {
+        if (this->pendingRebuild.valid())
+        {
+            this->pendingRebuild.wait();
+            this->pendingRebuild = {};
+        }
+    }
+
+    float rebuildThreshold;
+
+    std::vector<Box> objectBounds;
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> leafNodes;
+
+    std::vector<std::uint8_t> dirtyFlags;
+    std::vector<size_t> dirtyNodes;
+
+    float halfAreaSum = 0.0f;
+    float builtCost = 0.0f;
+
+    std::future<std::vector<Node>> pendingRebuild;
+};
+} // namespace ctoAssetsRTIS
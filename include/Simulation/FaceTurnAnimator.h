@@ -0,0 +1,267 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "TransformStore.h"
+
+
+namespace ctoAssetsRTIS
+{
+class FaceTurnAnimator
+{
+public:
+    static constexpr auto queueCapacity = size_t{ 1024 };
+
+    enum class Face : std::uint8_t
+    {
+        Right,
+        Left,
+        Up,
+        Down,
+        Front,
+        Back
+    };
+
+    struct Move
+    {
+        Face face;
+        int quarterTurns = 1;
+        float duration = 0.0f;
+    };
+
+    struct Configuration
+    {
+        TransformStore& transformStore;
+        float cubieSpacing;
+        float turnDuration;
+    };
+    FaceTurnAnimator(Configuration configuration)
+    : transformStore{ configuration.transformStore }
+    , cubieSpacing{ configuration.cubieSpacing }
+    , turnDuration{ configuration.turnDuration }
+    {
+        if (this->cubieSpacing <= 0.0f || this->turnDuration <= 0.0f)
+        {
+            throw std::invalid_argument(
+                "cubieSpacing and turnDuration must be greater than 0");
+        }
+    }
+
+    FaceTurnAnimator(const FaceTurnAnimator&) = delete;
+    FaceTurnAnimator(FaceTurnAnimator&&) = delete;
+    FaceTurnAnimator& operator=(const FaceTurnAnimator&) = delete;
+
+    void addCubie(size_t transformIndex)
+    {
+        this->cubies.push_back(transformIndex);
+        this->tracks.reserve(this->cubies.size());
+    }
+
+    void enqueue(Move move)
+    {
+        if (this->queuedMoveCount == queueCapacity)
+        {
+            throw std::runtime_error("Face turn queue is full");
+        }
+
+        this->moveQueue[
+            (this->firstQueuedMove + this->queuedMoveCount) % queueCapacity] =
+                move;
+        this->queuedMoveCount++;
+    }
+
+    void enqueueScramble(
+        size_t moveCount,
+        std::uint32_t seed,
+        float turnDuration)
+    {
+        auto randomEngine = std::minstd_rand(seed);
+
+        auto previousFace = -1;
+        for (auto i = size_t{}; i < moveCount; i++)
+        {
+            auto face = 0;
+            do
+            {
+                face = static_cast<int>(randomEngine() % 6);
+            }
+            while (face == previousFace);
+
+            previousFace = face;
+
+            constexpr auto quarterTurns = std::array{ 1, 2, -1 };
+            this->enqueue({
+                .face = static_cast<Face>(face),
+                .quarterTurns = quarterTurns[randomEngine() % 3],
+                .duration = turnDuration
+            });
+        }
+    }
+
+    bool isIdle() const
+    {
+        return !this->activeTurn && this->queuedMoveCount == 0;
+    }
+
+    // Consumes dt in full: several queued turns may start and finish within
+    // one step, and only the turn still in progress is interpolated.
+    void update(float dt)
+    {
+        auto remaining = dt;
+        while (remaining > 0.0f)
+        {
+            if (!this->activeTurn)
+            {
+                if (this->queuedMoveCount == 0)
+                {
+                    return;
+                }
+
+                this->beginTurn(this->moveQueue[this->firstQueuedMove]);
+                this->firstQueuedMove =
+                    (this->firstQueuedMove + 1) % queueCapacity;
+                this->queuedMoveCount--;
+            }
+
+            this->progress += remaining / this->activeTurnDuration;
+            if (this->progress < 1.0f)
+            {
+                this->evaluateTracks(this->progress);
+                return;
+            }
+
+            remaining = (this->progress - 1.0f) * this->activeTurnDuration;
+            this->finishTurn();
+        }
+    }
+
+private:
+    struct Track
+    {
+        size_t transformIndex;
+        glm::quat startOrientation;
+        glm::vec3 startPosition;
+    };
+
+    static float ease(float t)
+    {
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    void beginTurn(Move move)
+    {
+        const auto faceIndex = static_cast<int>(move.face);
+        const auto axis = static_cast<size_t>(faceIndex / 2);
+        const auto layer = faceIndex % 2 == 0 ? 1.0f : -1.0f;
+
+        auto axisVector = glm::vec3(0.0f);
+        axisVector[axis] = 1.0f;
+
+        this->turnRotation =
+            glm::angleAxis(
+                -layer * move.quarterTurns * std::numbers::pi_v<float> / 2.0f,
+                axisVector);
+
+        this->tracks.clear();
+        for (const auto transformIndex : this->cubies)
+        {
+            const auto position =
+                this->transformStore.getPosition(transformIndex);
+
+            if (position[axis] * layer < this->cubieSpacing / 2.0f)
+            {
+                continue;
+            }
+
+            this->tracks.push_back({
+                .transformIndex = transformIndex,
+                .startOrientation =
+                    this->transformStore.getOrientation(transformIndex),
+                .startPosition = position
+            });
+        }
+
+        this->activeTurn = true;
+        this->activeTurnDuration =
+            move.duration > 0.0f ? move.duration : this->turnDuration;
+        this->progress = 0.0f;
+    }
+
+    void evaluateTracks(float t)
+    {
+        const auto rotation =
+            glm::slerp(
+                glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                this->turnRotation,
+                ease(t));
+
+        for (const auto& track : this->tracks)
+        {
+            this->transformStore.setOrientation(
+                track.transformIndex,
+                rotation * track.startOrientation);
+            this->transformStore.setPosition(
+                track.transformIndex,
+                rotation * track.startPosition);
+        }
+    }
+
+    void finishTurn()
+    {
+        const auto snap =
+        [&](float value)
+        {
+            return std::round(value / this->cubieSpacing) * this->cubieSpacing;
+        };
+
+        for (const auto& track : this->tracks)
+        {
+            const auto position = this->turnRotation * track.startPosition;
+
+            this->transformStore.setOrientation(
+                track.transformIndex,
+                glm::normalize(this->turnRotation * track.startOrientation));
+            this->transformStore.setPosition(
+                track.transformIndex,
+                glm::vec3(
+                    snap(position.x),
+                    snap(position.y),
+                    snap(position.z)));
+        }
+
+        this->activeTurn = false;
+    }
+
+    TransformStore& transformStore;
+    const float cubieSpacing;
+    const float turnDuration;
+
+    std::vector<size_t> cubies;
+    std::vector<Track> tracks;
+
+    std::array<Move, queueCapacity> moveQueue{};
+    size_t firstQueuedMove = 0;
+    size_t queuedMoveCount = 0;
+
+    bool activeTurn = false;
+    float activeTurnDuration = 0.0f;
+    float progress = 0.0f;
+    glm::quat turnRotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+};
+} // namespace ctoAssetsRTIS
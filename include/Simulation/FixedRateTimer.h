@@ -6,17 +6,43 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
 #include <thread>
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten/emscripten.h>
 #endif
 
+#include "DurationHistogram.h"
+
 
 namespace ctoAssetsRTIS
 {
+// On native builds, endFrame sleeps toward the frame's deadline and spins
+// through the last spinDuration, which sleep cannot hit precisely. With
+// vsync, presenting already blocks until a vertical blank, so the period
+// snaps to a whole number of refresh intervals and only the intervals
+// beyond the first are waited out. On the web, requestAnimationFrame paces
+// the loop and blocking would only stall the browser, so dt is the time
+// between frame starts.
+//
+// Frame durations, and the parts of each frame spent working and sleeping,
+// are recorded into histograms for the whole session. Given a reportStream,
+// their percentiles and the hitch counts are written to it once per
+// reportInterval, along with the mean, standard deviation and largest
+// deviation of the last statisticsWindow frame times.
 template<typename T>
 class FixedRateTimer
 {
@@ -24,9 +50,22 @@ class FixedRateTimer
     using Duration = std::chrono::duration<T, std::milli>;
 
 public:
+    // Times since the clock started. Kept in double, which a float would
+    // quantize to whole milliseconds within hours; only the differences
+    // between them are converted to Duration.
+    using Timestamp = std::chrono::duration<double, std::milli>;
+
+    static constexpr auto statisticsWindow = size_t{ 120 };
+    static constexpr auto hitchThresholdCount = size_t{ 3 };
+
     struct FixedRateTimerConfiguration
     {
         T targetFPS;
+        T vsyncRefreshRate = 0;
+        std::array<T, hitchThresholdCount> hitchThresholds =
+            { T{25.0}, T{50.0}, T{100.0} };
+        std::ostream* reportStream = nullptr;
+        T reportInterval = T{10000.0};
     };
     FixedRateTimer(FixedRateTimerConfiguration configuration)
     : targetFrameDuration(
@@ -57,30 +96,87 @@ public:
 
         return Duration(T{1000.0} / configuration.targetFPS);
     }())
+    , refreshInterval(
+        configuration.vsyncRefreshRate > 0
+            ? Duration(T{1000.0} / configuration.vsyncRefreshRate)
+            : Duration::zero())
     , dt(this->targetFrameDuration.count())
+    , hitchThresholds{ configuration.hitchThresholds }
+    , reportStream{ configuration.reportStream }
+    , reportInterval(configuration.reportInterval)
     {
+        if (this->reportStream && !(this->reportInterval.count() > 0))
+        {
+            throw std::invalid_argument(
+                "reportInterval must be greater than 0");
+        }
     }
 
     void startFrame()
     {
-        this->frameStart = getTotalElapsedTimeMilliseconds();
+        const auto previousFrameStart = this->frameStart;
+        this->frameStart = getNow();
+
+#ifdef __EMSCRIPTEN__
+        // Capped so a tab returning from the background does not produce
+        // one huge step.
+        if (previousFrameStart != Timestamp::zero())
+        {
+            this->sleepDurations.record(
+                Duration(this->frameStart - this->workEnd).count());
+            this->recordDeltaTime(
+                std::min(
+                    Duration(this->frameStart - previousFrameStart),
+                    this->targetFrameDuration * 4));
+        }
+#else
+        static_cast<void>(previousFrameStart);
+#endif
     }
 
-    void endFrame()
+    struct EndFrameArguments
     {
-        const auto frameEnd = getTotalElapsedTimeMilliseconds();
-        const auto frameDuration = frameEnd - this->frameStart;
+        bool presented;
+    };
+    void endFrame([[maybe_unused]] EndFrameArguments arguments)
+    {
+        this->workEnd = getNow();
+        this->workDurations.record(
+            Duration(this->workEnd - this->frameStart).count());
+
+#ifndef __EMSCRIPTEN__
+        const auto frameEnd = this->workEnd;
 
-        if (frameDuration >= targetFrameDuration)
+        auto deadline = Timestamp(this->frameStart + this->targetFrameDuration);
+        if (arguments.presented && this->refreshInterval > Duration::zero())
         {
-            this->dt = frameDuration.count();
-            return;
+            const auto refreshIntervals =
+                std::max(
+                    std::round(
+                        this->targetFrameDuration / this->refreshInterval),
+                    T{1});
+
+            // Half an interval early, so the next swap waits for the
+            // intended blank rather than the one after.
+            deadline =
+                frameEnd
+                    + this->refreshInterval * (refreshIntervals - T{1})
+                    - this->refreshInterval / T{2};
         }
 
-        std::this_thread::sleep_for(targetFrameDuration - frameDuration);
-        const auto sleepEnd = getTotalElapsedTimeMilliseconds();
+        waitUntil(deadline);
+
+        const auto wakeTime = getNow();
+        this->sleepDurations.record(Duration(wakeTime - frameEnd).count());
+        this->recordDeltaTime(Duration(wakeTime - this->frameStart));
+#endif
 
-        this->dt = (sleepEnd - this->frameStart).count();
+        if (this->reportStream
+            && this->workEnd - this->lastReportTime >= this->reportInterval)
+        {
+            this->writeReport(*this->reportStream);
+            this->lastReportTime = this->workEnd;
+        }
     }
 
     T getDeltaTime() const
@@ -88,25 +184,192 @@ public:
         return this->dt;
     }
 
-    static Duration getTotalElapsedTimeMilliseconds()
+    // Over the last statisticsWindow frames, in milliseconds.
+    struct FrameTimeStatistics
+    {
+        T mean;
+        T standardDeviation;
+        T maximumDeviation;
+    };
+    FrameTimeStatistics getFrameTimeStatistics() const
+    {
+        const auto count = std::min(this->frameCount, statisticsWindow);
+        if (count == 0)
+        {
+            return { .mean = 0, .standardDeviation = 0, .maximumDeviation = 0 };
+        }
+
+        auto sum = T{};
+        for (auto i = size_t{}; i < count; i++)
+        {
+            sum += this->frameTimes[i];
+        }
+
+        const auto mean = sum / static_cast<T>(count);
+
+        auto squaredDeviationSum = T{};
+        auto maximumDeviation = T{};
+        for (auto i = size_t{}; i < count; i++)
+        {
+            const auto deviation = this->frameTimes[i] - mean;
+            squaredDeviationSum += deviation * deviation;
+            maximumDeviation = std::max(maximumDeviation, std::abs(deviation));
+        }
+
+        return
+            {
+                .mean = mean,
+                .standardDeviation =
+                    std::sqrt(squaredDeviationSum / static_cast<T>(count)),
+                .maximumDeviation = maximumDeviation
+            };
+    }
+
+    const DurationHistogram& getFrameDurations() const
+    {
+        return this->frameDurations;
+    }
+
+    const DurationHistogram& getWorkDurations() const
+    {
+        return this->workDurations;
+    }
+
+    const DurationHistogram& getSleepDurations() const
+    {
+        return this->sleepDurations;
+    }
+
+    // Frames longer than the corresponding hitch threshold.
+    std::span<const std::uint64_t, hitchThresholdCount> getHitchCounts() const
+    {
+        return this->hitchCounts;
+    }
+
+    // One line, formatted straight into the stream's buffer.
+    void writeReport(std::ostream& stream) const
+    {
+        auto output = std::ostreambuf_iterator<char>(stream);
+
+        output =
+            std::format_to(
+                output,
+                "frames {}",
+                this->frameDurations.getCount());
+
+        const auto writeHistogram =
+        [&](const char* name, const DurationHistogram& histogram)
+        {
+            output =
+                std::format_to(
+                    output,
+                    " | {} ms p50 {:.2f} p95 {:.2f} p99 {:.2f} max {:.2f}",
+                    name,
+                    histogram.getPercentile(50.0f),
+                    histogram.getPercentile(95.0f),
+                    histogram.getPercentile(99.0f),
+                    histogram.getMaximum());
+        };
+
+        writeHistogram("frame", this->frameDurations);
+        writeHistogram("work", this->workDurations);
+        writeHistogram("sleep", this->sleepDurations);
+
+        const auto statistics = this->getFrameTimeStatistics();
+        output =
+            std::format_to(
+                output,
+                " | jitter ms mean {:.2f} sd {:.2f} max deviation {:.2f}",
+                static_cast<double>(statistics.mean),
+                static_cast<double>(statistics.standardDeviation),
+                static_cast<double>(statistics.maximumDeviation));
+
+        output = std::format_to(output, " | hitches");
+        for (auto i = size_t{}; i < hitchThresholdCount; i++)
+        {
+            output =
+                std::format_to(
+                    output,
+                    " >{}ms {}",
+                    static_cast<double>(this->hitchThresholds[i]),
+                    this->hitchCounts[i]);
+        }
+
+        *output++ = '\n';
+        stream.flush();
+    }
+
+    static Timestamp getTotalElapsedTimeMilliseconds()
+    {
+        return getNow();
+    }
+
+private:
+    static constexpr auto spinDuration = std::chrono::milliseconds(2);
+
+    static Timestamp getNow()
     {
 #ifdef __EMSCRIPTEN__
-        const auto getNowMs =
-        []{ return static_cast<int64_t>(emscripten_get_now()); };
-        static const auto initialTimepoint = getNowMs();
-        return Duration(getNowMs() - initialTimepoint);
+        static const auto initialTimepoint = emscripten_get_now();
+        return Timestamp(emscripten_get_now() - initialTimepoint);
 #else
         static const auto initialTimepoint = Clock::now();
         return
             std::chrono::duration_cast<
-                Duration
+                Timestamp
             >(Clock::now() - initialTimepoint);
 #endif
     }
 
-private:
-    Duration frameStart;
+    static void waitUntil(Timestamp deadline)
+    {
+        const auto sleepDuration = deadline - getNow() - spinDuration;
+        if (sleepDuration > Timestamp::zero())
+        {
+            std::this_thread::sleep_for(sleepDuration);
+        }
+
+        while (getNow() < deadline)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    void recordDeltaTime(Duration deltaTime)
+    {
+        this->dt = deltaTime.count();
+
+        this->frameTimes[this->frameCount % statisticsWindow] = this->dt;
+        this->frameCount++;
+
+        this->frameDurations.record(this->dt);
+        for (auto i = size_t{}; i < hitchThresholdCount; i++)
+        {
+            if (this->dt > this->hitchThresholds[i])
+            {
+                this->hitchCounts[i]++;
+            }
+        }
+    }
+
+    Timestamp frameStart = Timestamp::zero();
     Duration targetFrameDuration;
+    Duration refreshInterval;
     T dt;
+
+    std::array<T, statisticsWindow> frameTimes{};
+    size_t frameCount = 0;
+
+    Timestamp workEnd = Timestamp::zero();
+    DurationHistogram frameDurations;
+    DurationHistogram workDurations;
+    DurationHistogram sleepDurations;
+
+    std::array<T, hitchThresholdCount> hitchThresholds;
+    std::array<std::uint64_t, hitchThresholdCount> hitchCounts{};
+
+    std::ostream* reportStream;
+    Duration reportInterval;
+    Timestamp lastReportTime = Timestamp::zero();
 };
 } // namespace ctoAssetsRTIS
@@ -0,0 +1,103 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+
+namespace ctoAssetsRTIS
+{
+// Advances a simulation in steps of stepDuration milliseconds whatever the
+// frame rate. Frame time accumulates and is consumed a step at a time, so a
+// frame runs zero or more steps. Past maximumStepsPerFrame the backlog is
+// dropped: a slow frame slows the simulation rather than making the next
+// frame slower still. The time left over, less than one step, gives the
+// interpolation factor between the last two simulated states.
+class FixedTimestep
+{
+public:
+    struct Configuration
+    {
+        float stepDuration;
+        size_t maximumStepsPerFrame;
+    };
+    FixedTimestep(Configuration configuration)
+    : stepDuration{ configuration.stepDuration }
+    , maximumStepsPerFrame{ configuration.maximumStepsPerFrame }
+    {
+        if (!(this->stepDuration > 0.0f) || this->maximumStepsPerFrame == 0)
+        {
+            throw std::invalid_argument(
+                "stepDuration and maximumStepsPerFrame must be greater than 0");
+        }
+    }
+
+    FixedTimestep(const FixedTimestep&) = delete;
+    FixedTimestep(FixedTimestep&&) = delete;
+    FixedTimestep& operator=(const FixedTimestep&) = delete;
+
+    // Calls step with the step duration once per step run, and returns the
+    // number of steps run.
+    template<typename Step>
+    size_t advance(float frameDuration, Step&& step)
+    {
+        this->accumulatedTime += frameDuration;
+
+        auto stepCount = size_t{};
+        while (this->accumulatedTime >= this->stepDuration
+            && stepCount < this->maximumStepsPerFrame)
+        {
+            step(this->stepDuration);
+
+            this->accumulatedTime -= this->stepDuration;
+            stepCount++;
+        }
+
+        if (this->accumulatedTime >= this->stepDuration)
+        {
+            this->accumulatedTime =
+                std::fmod(this->accumulatedTime, this->stepDuration);
+        }
+
+        this->totalStepCount += stepCount;
+
+        return stepCount;
+    }
+
+    // How far rendering is between the state before the last step, at 0,
+    // and the state after it, at 1.
+    float getInterpolationFactor() const
+    {
+        return this->accumulatedTime / this->stepDuration;
+    }
+
+    float getStepDuration() const
+    {
+        return this->stepDuration;
+    }
+
+    size_t getMaximumStepsPerFrame() const
+    {
+        return this->maximumStepsPerFrame;
+    }
+
+    std::uint64_t getTotalStepCount() const
+    {
+        return this->totalStepCount;
+    }
+
+private:
+    float stepDuration;
+    size_t maximumStepsPerFrame;
+
+    float accumulatedTime = 0.0f;
+    std::uint64_t totalStepCount = 0;
+};
+} // namespace ctoAssetsRTIS
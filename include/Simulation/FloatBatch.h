@@ -0,0 +1,283 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+
+namespace ctoAssetsRTIS
+{
+// One float per lane, one lane per object. storeMatrices takes the sixteen
+// column-major matrix elements as batches and writes one 4x4 matrix per lane.
+#if defined(__AVX2__) || defined(__SSE2__)
+namespace sseDetail
+{
+    inline void storeTransposed(
+        __m128 row0,
+        __m128 row1,
+        __m128 row2,
+        __m128 row3,
+        float* output,
+        size_t outputStride)
+    {
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+        _mm_storeu_ps(output, row0);
+        _mm_storeu_ps(output + outputStride, row1);
+        _mm_storeu_ps(output + outputStride * 2, row2);
+        _mm_storeu_ps(output + outputStride * 3, row3);
+    }
+}
+#endif
+
+#if defined(__AVX2__)
+struct FloatBatch
+{
+    static constexpr auto width = size_t{ 8 };
+
+    static FloatBatch load(const float* values)
+    {
+        return { _mm256_loadu_ps(values) };
+    }
+
+    static FloatBatch broadcast(float value)
+    {
+        return { _mm256_set1_ps(value) };
+    }
+
+    friend FloatBatch operator+(FloatBatch left, FloatBatch right)
+    {
+        return { _mm256_add_ps(left.value, right.value) };
+    }
+
+    friend FloatBatch operator-(FloatBatch left, FloatBatch right)
+    {
+        return { _mm256_sub_ps(left.value, right.value) };
+    }
+
+    friend FloatBatch operator*(FloatBatch left, FloatBatch right)
+    {
+        return { _mm256_mul_ps(left.value, right.value) };
+    }
+
+    friend FloatBatch operator/(FloatBatch left, FloatBatch right)
+    {
+        return { _mm256_div_ps(left.value, right.value) };
+    }
+
+    static void storeMatrices(
+        const std::array<FloatBatch, 16>& elements,
+        float* output)
+    {
+        for (auto column = size_t{}; column < 4; column++)
+        {
+            const auto* rows = &elements[column * 4];
+
+            sseDetail::storeTransposed(
+                _mm256_castps256_ps128(rows[0].value),
+                _mm256_castps256_ps128(rows[1].value),
+                _mm256_castps256_ps128(rows[2].value),
+                _mm256_castps256_ps128(rows[3].value),
+                output + column * 4,
+                16);
+
+            sseDetail::storeTransposed(
+                _mm256_extractf128_ps(rows[0].value, 1),
+                _mm256_extractf128_ps(rows[1].value, 1),
+                _mm256_extractf128_ps(rows[2].value, 1),
+                _mm256_extractf128_ps(rows[3].value, 1),
+                output + 64 + column * 4,
+                16);
+        }
+    }
+
+    __m256 value;
+};
+#elif defined(__SSE2__)
+struct FloatBatch
+{
+    static constexpr auto width = size_t{ 4 };
+
+    static FloatBatch load(const float* values)
+    {
+        return { _mm_loadu_ps(values) };
+    }
+
+    static FloatBatch broadcast(float value)
+    {
+        return { _mm_set1_ps(value) };
+    }
+
+    friend FloatBatch operator+(FloatBatch left, FloatBatch right)
+    {
+        return { _mm_add_ps(left.value, right.value) };
+    }
+
+    friend FloatBatch operator-(FloatBatch left, FloatBatch right)
+    {
+        return { _mm_sub_ps(left.value, right.value) };
+    }
+
+    friend FloatBatch operator*(FloatBatch left, FloatBatch right)
+    {
+        return { _mm_mul_ps(left.value, right.value) };
+    }
+
+    friend FloatBatch operator/(FloatBatch left, FloatBatch right)
+    {
+        return { _mm_div_ps(left.value, right.value) };
+    }
+
+    static void storeMatrices(
+        const std::array<FloatBatch, 16>& elements,
+        float* output)
+    {
+        for (auto column = size_t{}; column < 4; column++)
+        {
+            const auto* rows = &elements[column * 4];
+
+            sseDetail::storeTransposed(
+                rows[0].value,
+                rows[1].value,
+                rows[2].value,
+                rows[3].value,
+                output + column * 4,
+                16);
+        }
+    }
+
+    __m128 value;
+};
+#elif defined(__wasm_simd128__)
+struct FloatBatch
+{
+    static constexpr auto width = size_t{ 4 };
+
+    static FloatBatch load(const float* values)
+    {
+        return { wasm_v128_load(values) };
+    }
+
+    static FloatBatch broadcast(float value)
+    {
+        return { wasm_f32x4_splat(value) };
+    }
+
+    friend FloatBatch operator+(FloatBatch left, FloatBatch right)
+    {
+        return { wasm_f32x4_add(left.value, right.value) };
+    }
+
+    friend FloatBatch operator-(FloatBatch left, FloatBatch right)
+    {
+        return { wasm_f32x4_sub(left.value, right.value) };
+    }
+
+    friend FloatBatch operator*(FloatBatch left, FloatBatch right)
+    {
+        return { wasm_f32x4_mul(left.value, right.value) };
+    }
+
+    friend FloatBatch operator/(FloatBatch left, FloatBatch right)
+    {
+        return { wasm_f32x4_div(left.value, right.value) };
+    }
+
+    static void storeMatrices(
+        const std::array<FloatBatch, 16>& elements,
+        float* output)
+    {
+        for (auto column = size_t{}; column < 4; column++)
+        {
+            const auto* rows = &elements[column * 4];
+
+            const auto low01 =
+                wasm_i32x4_shuffle(rows[0].value, rows[1].value, 0, 4, 1, 5);
+            const auto high01 =
+                wasm_i32x4_shuffle(rows[0].value, rows[1].value, 2, 6, 3, 7);
+            const auto low23 =
+                wasm_i32x4_shuffle(rows[2].value, rows[3].value, 0, 4, 1, 5);
+            const auto high23 =
+                wasm_i32x4_shuffle(rows[2].value, rows[3].value, 2, 6, 3, 7);
+
+            auto* columnOutput = output + column * 4;
+            wasm_v128_store(
+                columnOutput,
+                wasm_i32x4_shuffle(low01, low23, 0, 1, 4, 5));
+            wasm_v128_store(
+                columnOutput + 16,
+                wasm_i32x4_shuffle(low01, low23, 2, 3, 6, 7));
+            wasm_v128_store(
+                columnOutput + 32,
+                wasm_i32x4_shuffle(high01, high23, 0, 1, 4, 5));
+            wasm_v128_store(
+                columnOutput + 48,
+                wasm_i32x4_shuffle(high01, high23, 2, 3, 6, 7));
+        }
+    }
+
+    v128_t value;
+};
+#else
+struct FloatBatch
+{
+    static constexpr auto width = size_t{ 1 };
+
+    static FloatBatch load(const float* values)
+    {
+        return { *values };
+    }
+
+    static FloatBatch broadcast(float value)
+    {
+        return { value };
+    }
+
+    friend FloatBatch operator+(FloatBatch left, FloatBatch right)
+    {
+        return { left.value + right.value };
+    }
+
+    friend FloatBatch operator-(FloatBatch left, FloatBatch right)
+    {
+        return { left.value - right.value };
+    }
+
+    friend FloatBatch operator*(FloatBatch left, FloatBatch right)
+    {
+        return { left.value * right.value };
+    }
+
+    friend FloatBatch operator/(FloatBatch left, FloatBatch right)
+    {
+        return { left.value / right.value };
+    }
+
+    static void storeMatrices(
+        const std::array<FloatBatch, 16>& elements,
+        float* output)
+    {
+        for (auto i = size_t{}; i < 16; i++)
+        {
+            output[i] = elements[i].value;
+        }
+    }
+
+    float value;
+};
+#endif
+} // namespace ctoAssetsRTIS
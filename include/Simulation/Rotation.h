@@ -57,6 +57,11 @@ public:
         return glm::mat4_cast(this->orientation);
     }
 
+    const glm::quat& getOrientation() const
+    {
+        return this->orientation;
+    }
+
 private:
     glm::quat orientation;
 };
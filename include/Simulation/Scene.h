@@ -0,0 +1,390 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <format>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "Graphics/Model/Mesh/MeshBvh.h"
+#include "Graphics/Model/Mesh/PartitionedMeshData.h"
+#include "Graphics/Model/Model.h"
+#include "DynamicAabbTree.h"
+#include "SceneDescription.h"
+#include "TransformStore.h"
+
+
+namespace ctoAssetsRTIS
+{
+class Scene
+{
+public:
+    struct ModelBinding
+    {
+        std::string_view name;
+        const Model& model;
+        std::span<const MeshInstance> instances = {};
+        const MeshBvh* bvh = nullptr;
+    };
+
+    struct StaticObject
+    {
+        const Model& model;
+        const std::array<float, 16>& modelMatrix;
+    };
+
+    struct DynamicObject
+    {
+        const Model& model;
+        size_t transformIndex;
+        std::span<const MeshData::MaterialChunk> materialChunks = {};
+        const MeshBvh* bvh = nullptr;
+    };
+
+    // A placement of an instanced model: one root transform, parent to the
+    // transforms of a contiguous run of dynamic objects.
+    struct InstanceGroup
+    {
+        size_t rootTransformIndex;
+        size_t firstObject;
+        size_t objectCount;
+    };
+
+    struct Properties
+    {
+        SceneDescription description;
+        std::span<const ModelBinding> modelBindings;
+    };
+    Scene(Properties properties)
+    {
+        const auto& [description, modelBindings] = properties;
+
+        const auto findModelBinding =
+        [&](std::string_view modelName) -> const ModelBinding&
+        {
+            const auto modelBindingsIterator =
+                std::find_if(
+                    modelBindings.begin(),
+                    modelBindings.end(),
+                    [&](const auto& modelBinding)
+                    {
+                        return modelBinding.name == modelName;
+                    });
+
+            if (modelBindingsIterator == modelBindings.end())
+            {
+                throw
+                    std::runtime_error(
+                        std::format("Cannot find model: {}", modelName));
+            }
+
+            return *modelBindingsIterator;
+        };
+
+        this->staticObjects.reserve(description.staticObjects.size());
+        for (const auto& staticObject : description.staticObjects)
+        {
+            const auto& modelBinding =
+                findModelBinding(staticObject.modelName);
+
+            if (!modelBinding.instances.empty())
+            {
+                throw
+                    std::runtime_error(
+                        std::format(
+                            "Instanced model must be placed dynamically: {}",
+                            modelBinding.name));
+            }
+
+            this->staticObjects.push_back({
+                .model = modelBinding.model,
+                .modelMatrix = staticObject.modelMatrix
+            });
+        }
+
+        for (const auto& dynamicObject : description.dynamicObjects)
+        {
+            const auto& modelBinding =
+                findModelBinding(dynamicObject.modelName);
+
+            const auto transformIndex =
+                this->transformStore.add(
+                    dynamicObject.placement.toTransform());
+
+            if (modelBinding.instances.empty())
+            {
+                this->dynamicObjects.push_back({
+                    .model = modelBinding.model,
+                    .transformIndex = transformIndex,
+                    .bvh = modelBinding.bvh
+                });
+
+                continue;
+            }
+
+            this->instanceGroups.push_back({
+                .rootTransformIndex = transformIndex,
+                .firstObject = this->dynamicObjects.size(),
+                .objectCount = modelBinding.instances.size()
+            });
+
+            for (const auto& instance : modelBinding.instances)
+            {
+                const auto& offset = instance.offset;
+
+                this->dynamicObjects.push_back({
+                    .model = modelBinding.model,
+                    .transformIndex =
+                        this->transformStore.add(
+                            Transform
+                            {
+                                .position =
+                                    glm::vec3(offset[0], offset[1], offset[2]),
+                                .scale = glm::vec3(1.0f),
+                                .rotation = Rotation()
+                            },
+                            transformIndex),
+                    .materialChunks = instance.materialChunks,
+                    .bvh = modelBinding.bvh
+                });
+            }
+        }
+
+        this->indexDynamicObjects();
+    }
+
+    Scene(const Scene&) = delete;
+    Scene(Scene&&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    std::span<const StaticObject> getStaticObjects() const
+    {
+        return this->staticObjects;
+    }
+
+    std::span<const DynamicObject> getDynamicObjects() const
+    {
+        return this->dynamicObjects;
+    }
+
+    std::span<const InstanceGroup> getInstanceGroups() const
+    {
+        return this->instanceGroups;
+    }
+
+    TransformStore& getTransformStore()
+    {
+        return this->transformStore;
+    }
+
+    const TransformStore& getTransformStore() const
+    {
+        return this->transformStore;
+    }
+
+    void updateModelMatrices(
+        float interpolationFactor = 1.0f,
+        JobSystem* jobSystem = nullptr)
+    {
+        this->transformStore.computeModelMatrices(
+            interpolationFactor,
+            jobSystem);
+
+        for (const auto transformIndex
+            : this->transformStore.getUpdatedIndices())
+        {
+            if (transformIndex >= this->indexedObjectsByTransform.size())
+            {
+                continue;
+            }
+
+            const auto indexedObject =
+                this->indexedObjectsByTransform[transformIndex];
+            if (indexedObject != notIndexed)
+            {
+                this->objectTree.setBounds(
+                    indexedObject,
+                    this->getWorldBounds(
+                        this->dynamicObjects[
+                            this->indexedObjects[indexedObject]]));
+            }
+        }
+
+        this->objectTree.update();
+    }
+
+    // Appends the indices of dynamic objects that may be inside the frustum.
+    // Objects whose model has no bounding volume hierarchy are always
+    // included.
+    void findVisibleDynamicObjects(
+        const DynamicAabbTree::Frustum& frustum,
+        std::pmr::vector<size_t>& visibleObjects) const
+    {
+        visibleObjects.insert(
+            visibleObjects.end(),
+            this->unindexedObjects.begin(),
+            this->unindexedObjects.end());
+
+        this->objectTree.queryFrustum(
+            frustum,
+            [&](size_t indexedObject)
+            {
+                visibleObjects.push_back(this->indexedObjects[indexedObject]);
+            });
+    }
+
+    // Appends the indices of indexed dynamic objects whose bounds overlap
+    // the box.
+    void findDynamicObjects(
+        const DynamicAabbTree::Box& bounds,
+        std::pmr::vector<size_t>& objects) const
+    {
+        this->objectTree.queryBox(
+            bounds,
+            [&](size_t indexedObject)
+            {
+                objects.push_back(this->indexedObjects[indexedObject]);
+            });
+    }
+
+    struct Pick
+    {
+        size_t object;
+        size_t triangle;
+        std::optional<size_t> materialChunk;
+        float distance;
+        glm::vec3 point;
+    };
+
+    // Nearest hit among dynamic objects whose model has a bounding volume
+    // hierarchy, against the model matrices of the last update. Distances
+    // are in units of the ray direction.
+    std::optional<Pick> pick(
+        const MeshBvh::Ray& ray,
+        float maximumDistance = 1.0f) const
+    {
+        const auto modelMatrices = this->transformStore.getModelMatrices();
+
+        // Candidates are intersected as the tree visits them, so picking
+        // does not allocate.
+        auto result = std::optional<Pick>();
+        this->objectTree.queryRay(
+            ray.origin,
+            ray.direction,
+            maximumDistance,
+            [&](size_t indexedObject)
+            {
+                const auto i = this->indexedObjects[indexedObject];
+                const auto& dynamicObject = this->dynamicObjects[i];
+                const auto hit =
+                    dynamicObject.bvh->intersect(
+                        ray.transformed(
+                            glm::inverse(
+                                modelMatrices[dynamicObject.transformIndex])),
+                        maximumDistance);
+
+                if (!hit)
+                {
+                    return;
+                }
+
+                maximumDistance = hit->distance;
+
+                const auto materialChunks =
+                    dynamicObject.materialChunks.empty()
+                        ? dynamicObject.model.mesh.materialChunks
+                        : dynamicObject.materialChunks;
+
+                result =
+                    Pick
+                    {
+                        .object = i,
+                        .triangle = hit->triangle,
+                        .materialChunk =
+                            MeshBvh::findMaterialChunk(
+                                materialChunks,
+                                hit->triangle),
+                        .distance = hit->distance,
+                        .point = ray.origin + ray.direction * hit->distance
+                    };
+            });
+
+        return result;
+    }
+
+private:
+    static constexpr auto notIndexed = std::numeric_limits<size_t>::max();
+
+    DynamicAabbTree::Box getWorldBounds(
+        const DynamicObject& dynamicObject) const
+    {
+        const auto& root = dynamicObject.bvh->nodes[0];
+
+        const auto toVector =
+        [](const std::array<float, 3>& point)
+        {
+            return glm::vec3(point[0], point[1], point[2]);
+        };
+
+        return
+            DynamicAabbTree::Box
+            {
+                .minimum = toVector(root.minimum),
+                .maximum = toVector(root.maximum)
+            }.transformed(
+                this->transformStore.getModelMatrices()[
+                    dynamicObject.transformIndex]);
+    }
+
+    // Objects with a bounding volume hierarchy are indexed by the bounds of
+    // its root.
+    void indexDynamicObjects()
+    {
+        this->transformStore.computeModelMatrices();
+
+        this->indexedObjectsByTransform.assign(
+            this->transformStore.size(),
+            notIndexed);
+
+        auto bounds = std::vector<DynamicAabbTree::Box>();
+        for (auto i = size_t{}; i < this->dynamicObjects.size(); i++)
+        {
+            const auto& dynamicObject = this->dynamicObjects[i];
+            if (dynamicObject.bvh == nullptr)
+            {
+                this->unindexedObjects.push_back(i);
+                continue;
+            }
+
+            this->indexedObjectsByTransform[dynamicObject.transformIndex] =
+                this->indexedObjects.size();
+            this->indexedObjects.push_back(i);
+            bounds.push_back(this->getWorldBounds(dynamicObject));
+        }
+
+        this->objectTree.reset(bounds);
+    }
+
+    std::vector<StaticObject> staticObjects;
+    std::vector<DynamicObject> dynamicObjects;
+    std::vector<InstanceGroup> instanceGroups;
+    TransformStore transformStore;
+
+    DynamicAabbTree objectTree =
+        DynamicAabbTree({ .rebuildThreshold = 1.5f });
+    std::vector<size_t> indexedObjects;
+    std::vector<size_t> indexedObjectsByTransform;
+    std::vector<size_t> unindexedObjects;
+};
+} // namespace ctoAssetsRTIS
@@ -0,0 +1,288 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <array>
+#include <numbers>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Serialization/Deserialize.h"
+#include "Serialization/ParseStructuredSequentialData.h"
+#include "Transform.h"
+
+
+namespace ctoAssetsRTIS
+{
+struct SceneDescription
+{
+    struct Placement
+    {
+        std::array<float, 3> position;
+        Rotation::EulerAnglesDegrees rotation;
+        std::array<float, 3> scale;
+
+        Transform toTransform() const
+        {
+            return
+                Transform
+                {
+                    .position =
+                        glm::vec3(
+                            this->position[0],
+                            this->position[1],
+                            this->position[2]),
+                    .scale =
+                        glm::vec3(
+                            this->scale[0],
+                            this->scale[1],
+                            this->scale[2]),
+                    .rotation = Rotation(this->rotation)
+                };
+        }
+    };
+
+    struct StaticObject
+    {
+        std::string_view modelName;
+        std::array<float, 16> modelMatrix;
+    };
+
+    struct DynamicObject
+    {
+        std::string_view modelName;
+        Placement placement;
+    };
+
+    std::span<const StaticObject> staticObjects;
+    std::span<const DynamicObject> dynamicObjects;
+};
+
+template<typename StringProvider>
+class CompileTimeDeserialize<SceneDescription, StringProvider>
+{
+private:
+    static constexpr auto& parsedModelDirectives =
+        ParseSceneDescription<StringProvider>::value;
+
+    static constexpr auto modelDirectivesCount =
+        std::tuple_size<
+            typename std::decay<decltype(parsedModelDirectives)>::type
+        >::value;
+
+    static constexpr auto idStringCache =
+        std::apply(
+            [](auto&&... modelDirectives)
+            {
+                return
+                    std::make_tuple(
+                        AutomaticDurationString(modelDirectives.id)...);
+            },
+            parsedModelDirectives);
+
+    static constexpr auto staticObjectCount =
+        std::apply(
+            [](const auto&... modelDirectives)
+            {
+                return
+                    (size_t{} + ... + modelDirectives.staticPlacements.size());
+            },
+            parsedModelDirectives);
+
+    static constexpr auto dynamicObjectCount =
+        std::apply(
+            [](const auto&... modelDirectives)
+            {
+                return
+                    (size_t{} + ... + modelDirectives.dynamicPlacements.size());
+            },
+            parsedModelDirectives);
+
+    static constexpr double sine(double angle)
+    {
+        constexpr auto twoPi = 2.0 * std::numbers::pi;
+
+        angle -= twoPi * static_cast<long long>(angle / twoPi);
+        if (angle > std::numbers::pi)
+        {
+            angle -= twoPi;
+        }
+        else if (angle < -std::numbers::pi)
+        {
+            angle += twoPi;
+        }
+
+        auto term = angle;
+        auto result = angle;
+        for (auto n = 1; n <= 12; n++)
+        {
+            term *= -angle * angle / ((2.0 * n) * (2.0 * n + 1.0));
+            result += term;
+        }
+
+        return result;
+    }
+
+    static constexpr double cosine(double angle)
+    {
+        return sine(angle + std::numbers::pi / 2.0);
+    }
+
+    static constexpr auto toPlacement(const std::array<float, 9>& values)
+    {
+        return
+            SceneDescription::Placement
+            {
+                .position = { values[0], values[1], values[2] },
+                .rotation =
+                {
+                    .yaw = values[3],
+                    .pitch = values[4],
+                    .roll = values[5]
+                },
+                .scale = { values[6], values[7], values[8] }
+            };
+    }
+
+    // Mirrors Transform::getModelMatrix for a quaternion built the way
+    // Rotation::EulerAnglesDegrees::toQuaternion builds it.
+    static constexpr auto makeModelMatrix(
+        const SceneDescription::Placement& placement)
+    {
+        constexpr auto radiansPerDegree = std::numbers::pi / 180.0;
+
+        const auto halfAngles =
+            std::array<double, 3>
+            {
+                placement.rotation.pitch * radiansPerDegree / 2.0,
+                placement.rotation.yaw * radiansPerDegree / 2.0,
+                placement.rotation.roll * radiansPerDegree / 2.0
+            };
+
+        auto c = std::array<double, 3>{};
+        auto s = std::array<double, 3>{};
+        for (auto i = size_t{}; i < 3; i++)
+        {
+            c[i] = cosine(halfAngles[i]);
+            s[i] = sine(halfAngles[i]);
+        }
+
+        const auto w = c[0] * c[1] * c[2] + s[0] * s[1] * s[2];
+        const auto x = s[0] * c[1] * c[2] - c[0] * s[1] * s[2];
+        const auto y = c[0] * s[1] * c[2] + s[0] * c[1] * s[2];
+        const auto z = c[0] * c[1] * s[2] - s[0] * s[1] * c[2];
+
+        const auto rotation =
+            std::array<double, 9>
+            {
+                1.0 - 2.0 * (y * y + z * z),
+                2.0 * (x * y + w * z),
+                2.0 * (x * z - w * y),
+
+                2.0 * (x * y - w * z),
+                1.0 - 2.0 * (x * x + z * z),
+                2.0 * (y * z + w * x),
+
+                2.0 * (x * z + w * y),
+                2.0 * (y * z - w * x),
+                1.0 - 2.0 * (x * x + y * y)
+            };
+
+        auto result = std::array<float, 16>{};
+        for (auto column = size_t{}; column < 3; column++)
+        {
+            for (auto row = size_t{}; row < 3; row++)
+            {
+                result[column * 4 + row] =
+                    static_cast<float>(
+                        rotation[column * 3 + row]
+                            * placement.scale[column]);
+            }
+
+            result[12 + column] = placement.position[column];
+        }
+
+        result[15] = 1.0f;
+
+        return result;
+    }
+
+    static constexpr auto staticObjects =
+    []
+    {
+        auto result =
+            std::array<SceneDescription::StaticObject, staticObjectCount>{};
+
+        auto offset = size_t{};
+        [&]<size_t... Indices>(std::index_sequence<Indices...>)
+        {
+            ([&]
+            {
+                const auto& modelDirective =
+                    std::get<Indices>(parsedModelDirectives);
+
+                for (const auto& placement : modelDirective.staticPlacements)
+                {
+                    result[offset++] =
+                        SceneDescription::StaticObject
+                        {
+                            .modelName =
+                                std::get<Indices>(idStringCache)
+                                    .toStringView(),
+                            .modelMatrix =
+                                makeModelMatrix(toPlacement(placement))
+                        };
+                }
+            }(), ...);
+        }(std::make_index_sequence<modelDirectivesCount>{});
+
+        return result;
+    }();
+
+    static constexpr auto dynamicObjects =
+    []
+    {
+        auto result =
+            std::array<SceneDescription::DynamicObject, dynamicObjectCount>{};
+
+        auto offset = size_t{};
+        [&]<size_t... Indices>(std::index_sequence<Indices...>)
+        {
+            ([&]
+            {
+                const auto& modelDirective =
+                    std::get<Indices>(parsedModelDirectives);
+
+                for (const auto& placement : modelDirective.dynamicPlacements)
+                {
+                    result[offset++] =
+                        SceneDescription::DynamicObject
+                        {
+                            .modelName =
+                                std::get<Indices>(idStringCache)
+                                    .toStringView(),
+                            .placement = toPlacement(placement)
+                        };
+                }
+            }(), ...);
+        }(std::make_index_sequence<modelDirectivesCount>{});
+
+        return result;
+    }();
+
+public:
+    static constexpr auto value =
+        SceneDescription
+        {
+            .staticObjects = staticObjects,
+            .dynamicObjects = dynamicObjects
+        };
+};
+} // namespace ctoAssetsRTIS
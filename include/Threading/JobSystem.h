@@ -0,0 +1,313 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingDeque.h"
+
+
+namespace ctoAssetsRTIS
+{
+// Counts the jobs run against it that have yet to finish.
+struct JobCounter
+{
+    std::atomic<size_t> pending = 0;
+
+    bool isDone() const
+    {
+        return this->pending.load(std::memory_order_acquire) == 0;
+    }
+};
+
+// Must outlive every run of it, which wait on its counter guarantees.
+struct Job
+{
+    void (*function)(void* context);
+    void* context;
+    JobCounter* counter;
+};
+
+// Work-stealing scheduler over workerCount threads plus one submitting
+// thread, which takes part whenever it waits. Each thread owns a
+// Chase–Lev deque: it pushes and pops its own jobs at one end while idle
+// threads steal from the other. Waiting threads run jobs rather than block,
+// so jobs may run and wait on others. With no workers, or in builds without
+// threads, jobs run inline as they are submitted.
+//
+// Only one JobSystem may exist at a time. Other than its workers, only one
+// thread may submit to it, though it need not be the one that constructed
+// it.
+class JobSystem
+{
+public:
+    static constexpr auto dequeCapacity = size_t{ 1024 };
+
+    static size_t getDefaultWorkerCount()
+    {
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+        const auto hardwareConcurrency = std::thread::hardware_concurrency();
+
+        return hardwareConcurrency > 1 ? hardwareConcurrency - 1 : 0;
+#else
+        return 0;
+#endif
+    }
+
+    struct Configuration
+    {
+        size_t workerCount = getDefaultWorkerCount();
+    };
+    JobSystem(Configuration configuration)
+    {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+        configuration.workerCount = 0;
+#endif
+        workerIndex() = 0;
+
+        this->deques.reserve(configuration.workerCount + 1);
+        for (auto i = size_t{}; i <= configuration.workerCount; i++)
+        {
+            this->deques.push_back(std::make_unique<Deque>());
+        }
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+        this->workers.reserve(configuration.workerCount);
+        for (auto i = size_t{ 1 }; i <= configuration.workerCount; i++)
+        {
+            this->workers.emplace_back(
+                [this, i]
+                {
+                    workerIndex() = i;
+                    this->work();
+                });
+        }
+#endif
+    }
+
+    ~JobSystem()
+    {
+        this->stopping.store(true, std::memory_order_relaxed);
+        this->wakeWorkers();
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+        for (auto& worker : this->workers)
+        {
+            worker.join();
+        }
+#endif
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    size_t getWorkerCount() const
+    {
+        return this->deques.size() - 1;
+    }
+
+    // Counts the job against its counter, then queues it on the calling
+    // thread's deque, or runs it at once if there is no room or no one
+    // else to run it.
+    void run(Job& job)
+    {
+        job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+        if (this->getWorkerCount() == 0
+            || !this->deques[workerIndex()]->push(&job))
+        {
+            execute(job);
+            return;
+        }
+
+        this->wakeWorkers();
+    }
+
+    void wait(const JobCounter& counter)
+    {
+        while (!counter.isDone())
+        {
+            if (auto* job = this->findJob())
+            {
+                execute(*job);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Calls body(chunkBegin, chunkEnd) over [begin, end) in chunks of at
+    // most grainSize. Chunks are claimed from a shared index by the calling
+    // thread and by one job per worker, so uneven chunks balance out.
+    template<typename Body>
+    void parallelFor(size_t begin, size_t end, size_t grainSize, Body&& body)
+    {
+        if (grainSize == 0)
+        {
+            throw std::invalid_argument("grainSize must be greater than 0");
+        }
+
+        if (end <= begin)
+        {
+            return;
+        }
+
+        const auto chunkCount = (end - begin + grainSize - 1) / grainSize;
+        if (this->getWorkerCount() == 0 || chunkCount == 1)
+        {
+            body(begin, end);
+            return;
+        }
+
+        struct Range
+        {
+            Body& body;
+            size_t begin;
+            size_t end;
+            size_t grainSize;
+            size_t chunkCount;
+            std::atomic<size_t> nextChunk = 0;
+
+            void runChunks()
+            {
+                while (true)
+                {
+                    const auto chunk =
+                        this->nextChunk.fetch_add(
+                            1,
+                            std::memory_order_relaxed);
+                    if (chunk >= this->chunkCount)
+                    {
+                        return;
+                    }
+
+                    const auto chunkBegin =
+                        this->begin + chunk * this->grainSize;
+                    this->body(
+                        chunkBegin,
+                        std::min(chunkBegin + this->grainSize, this->end));
+                }
+            }
+        };
+
+        auto range =
+            Range
+            {
+                .body = body,
+                .begin = begin,
+                .end = end,
+                .grainSize = grainSize,
+                .chunkCount = chunkCount
+            };
+
+        auto counter = JobCounter();
+        auto job =
+            Job
+            {
+                .function =
+                    [](void* context)
+                    {
+                        static_cast<Range*>(context)->runChunks();
+                    },
+                .context = &range,
+                .counter = &counter
+            };
+
+        const auto helperCount =
+            std::min(chunkCount - 1, this->getWorkerCount());
+        for (auto i = size_t{}; i < helperCount; i++)
+        {
+            this->run(job);
+        }
+
+        range.runChunks();
+        this->wait(counter);
+    }
+
+private:
+    using Deque = WorkStealingDeque<Job, dequeCapacity>;
+
+    static size_t& workerIndex()
+    {
+        static thread_local auto index = size_t{};
+        return index;
+    }
+
+    static void execute(Job& job)
+    {
+        auto* counter = job.counter;
+        job.function(job.context);
+        counter->pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    Job* findJob()
+    {
+        const auto self = workerIndex();
+        if (auto* job = this->deques[self]->pop())
+        {
+            return job;
+        }
+
+        for (auto i = size_t{ 1 }; i < this->deques.size(); i++)
+        {
+            if (auto* job =
+                this->deques[(self + i) % this->deques.size()]->steal())
+            {
+                return job;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void wakeWorkers()
+    {
+        this->wakeCount.fetch_add(1, std::memory_order_release);
+        this->wakeCount.notify_all();
+    }
+
+    // Workers sleep once a search finds nothing, until the next wake. The
+    // wake count is read before searching, so a job pushed during the
+    // search still wakes them.
+    void work()
+    {
+        while (!this->stopping.load(std::memory_order_relaxed))
+        {
+            const auto observedWakeCount =
+                this->wakeCount.load(std::memory_order_acquire);
+
+            if (auto* job = this->findJob())
+            {
+                execute(*job);
+                continue;
+            }
+
+            this->wakeCount.wait(
+                observedWakeCount,
+                std::memory_order_acquire);
+        }
+    }
+
+    std::vector<std::unique_ptr<Deque>> deques;
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+    std::vector<std::thread> workers;
+#endif
+
+    std::atomic<std::uint32_t> wakeCount = 0;
+    std::atomic<bool> stopping = false;
+};
+} // namespace ctoAssetsRTIS
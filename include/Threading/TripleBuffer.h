@@ -0,0 +1,82 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+
+namespace ctoAssetsRTIS
+{
+// Hands the latest of a stream of values from one producer thread to one
+// consumer thread without either waiting on the other. The producer fills
+// the back buffer and publishes it; the consumer acquires the most recently
+// published one. Values published faster than they are acquired replace
+// one another. Buffers are reused, so a T that keeps its storage, such as
+// one holding vectors, stops allocating once the three have grown.
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer(TripleBuffer&&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer only. Holds whatever was last written to it, not the last
+    // value published.
+    T& getBackBuffer()
+    {
+        return this->buffers[this->backIndex];
+    }
+
+    // Producer only.
+    void publish()
+    {
+        this->backIndex =
+            this->middle.exchange(
+                this->backIndex | freshBit,
+                std::memory_order_acq_rel)
+            & indexMask;
+    }
+
+    // Consumer only. Whether a value was published since the last acquire;
+    // if not, the front buffer is unchanged.
+    bool acquire()
+    {
+        if ((this->middle.load(std::memory_order_relaxed) & freshBit) == 0)
+        {
+            return false;
+        }
+
+        this->frontIndex =
+            this->middle.exchange(
+                this->frontIndex,
+                std::memory_order_acq_rel)
+            & indexMask;
+
+        return true;
+    }
+
+    // Consumer only.
+    const T& getFrontBuffer() const
+    {
+        return this->buffers[this->frontIndex];
+    }
+
+private:
+    static constexpr auto indexMask = std::uint8_t{ 0b011 };
+    static constexpr auto freshBit = std::uint8_t{ 0b100 };
+
+    std::array<T, 3> buffers{};
+    std::uint8_t backIndex = 0;
+    alignas(64) std::atomic<std::uint8_t> middle = 1;
+    alignas(64) std::uint8_t frontIndex = 2;
+};
+} // namespace ctoAssetsRTIS
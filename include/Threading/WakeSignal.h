@@ -0,0 +1,73 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <stop_token>
+
+
+namespace ctoAssetsRTIS
+{
+// Wakes a thread waiting on it. A notification sent while no thread waits
+// is kept, so the next wait returns at once; any number of notifications
+// wake it once.
+class WakeSignal
+{
+public:
+    WakeSignal() = default;
+
+    WakeSignal(const WakeSignal&) = delete;
+    WakeSignal(WakeSignal&&) = delete;
+    WakeSignal& operator=(const WakeSignal&) = delete;
+
+    void notify()
+    {
+        {
+            const auto lock = std::lock_guard(this->mutex);
+            this->notified = true;
+        }
+
+        this->condition.notify_one();
+    }
+
+    // Blocks until notified, the timeout, which may be infinite, elapses, or
+    // stop is requested.
+    void waitFor(float timeoutMilliseconds, std::stop_token stopToken)
+    {
+        auto lock = std::unique_lock(this->mutex);
+
+        const auto isNotified =
+        [this]
+        {
+            return this->notified;
+        };
+
+        if (std::isinf(timeoutMilliseconds))
+        {
+            this->condition.wait(lock, stopToken, isNotified);
+        }
+        else
+        {
+            this->condition.wait_for(
+                lock,
+                stopToken,
+                std::chrono::duration<float, std::milli>(timeoutMilliseconds),
+                isNotified);
+        }
+
+        this->notified = false;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable_any condition;
+    bool notified = false;
+};
+} // namespace ctoAssetsRTIS
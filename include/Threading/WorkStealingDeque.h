@@ -0,0 +1,116 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace ctoAssetsRTIS
+{
+// Chase–Lev deque with the memory orderings of Lê et al., "Correct and
+// Efficient Work-Stealing for Weak Memory Models". The owning thread pushes
+// and pops at the bottom; any thread may steal from the top. The buffer is
+// fixed, so push fails rather than grows when it is full.
+template<typename T, size_t Capacity>
+class WorkStealingDeque
+{
+    static_assert(
+        Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+        "Capacity must be a power of two");
+
+public:
+    WorkStealingDeque() = default;
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque(WorkStealingDeque&&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only.
+    bool push(T* item)
+    {
+        const auto bottom = this->bottom.load(std::memory_order_relaxed);
+        const auto top = this->top.load(std::memory_order_acquire);
+        if (bottom - top >= static_cast<std::int64_t>(Capacity))
+        {
+            return false;
+        }
+
+        this->items[bottom & mask].store(item, std::memory_order_relaxed);
+        this->bottom.store(bottom + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Owner only. Null when empty.
+    T* pop()
+    {
+        const auto bottom = this->bottom.load(std::memory_order_relaxed) - 1;
+        this->bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = this->top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            this->bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto* item = this->items[bottom & mask].load(std::memory_order_relaxed);
+        if (top == bottom)
+        {
+            // The last item: race thieves for it.
+            if (!this->top.compare_exchange_strong(
+                top,
+                top + 1,
+                std::memory_order_seq_cst,
+                std::memory_order_relaxed))
+            {
+                item = nullptr;
+            }
+
+            this->bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return item;
+    }
+
+    // Any thread. Null when empty or when another thread won the item.
+    T* steal()
+    {
+        auto top = this->top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto bottom = this->bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+        {
+            return nullptr;
+        }
+
+        auto* item = this->items[top & mask].load(std::memory_order_relaxed);
+        if (!this->top.compare_exchange_strong(
+            top,
+            top + 1,
+            std::memory_order_seq_cst,
+            std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+
+        return item;
+    }
+
+private:
+    static constexpr auto mask = static_cast<std::int64_t>(Capacity - 1);
+
+    alignas(64) std::atomic<std::int64_t> top = 0;
+    alignas(64) std::atomic<std::int64_t> bottom = 0;
+    std::array<std::atomic<T*>, Capacity> items{};
+};
+} // namespace ctoAssetsRTIS
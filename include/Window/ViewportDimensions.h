@@ -32,6 +32,8 @@ public:
     int getWidth() const { return this->width; }
     int getHeight() const { return this->height; }
 
+    bool operator==(const ViewportDimensions&) const = default;
+
 #ifdef __EMSCRIPTEN__
     static auto fromCanvasSize()
     {
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <span>
 
@@ -47,8 +48,11 @@ public:
     {
         const char* title;
         ViewportDimensions viewportDimensions;
+        // Never shown, but drawn to as if it were.
+        bool headless = false;
     };
     WindowSystem(Properties properties)
+    : headless{ properties.headless }
     {
         if (!glfwInit())
         {
@@ -60,6 +64,7 @@ public:
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
         glfwWindowHint(GLFW_SAMPLES, 16);
+        glfwWindowHint(GLFW_VISIBLE, this->headless ? GLFW_FALSE : GLFW_TRUE);
 
         const auto [width, height] = properties.viewportDimensions;
 
@@ -121,6 +126,19 @@ public:
 
         glEnable(GL_DEPTH_TEST);
         glEnable(GL_MULTISAMPLE);
+
+        // WebGL 2 always restarts at the maximum index; desktop GL 3.3 needs
+        // the equivalent configured explicitly.
+#ifndef __EMSCRIPTEN__
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(std::numeric_limits<GLuint>::max());
+#endif
+
+        // Swaps wait for vsync, which the frame pacer measures presented
+        // frames against. The browser paces its own animation frames.
+#ifndef __EMSCRIPTEN__
+        glfwSwapInterval(1);
+#endif
     }
 
     ~WindowSystem()
@@ -144,7 +162,42 @@ public:
         glfwSwapBuffers(this->window.get());
     }
 
+    // Of the primary monitor, or 0 where presentation is not vsync-paced by
+    // swapBuffers.
+    float getRefreshRate() const
+    {
+#ifdef __EMSCRIPTEN__
+        return 0.0f;
+#else
+        const auto* videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+
+        return
+            videoMode != nullptr
+                ? static_cast<float>(videoMode->refreshRate)
+                : 0.0f;
+#endif
+    }
+
+    // Minimized or hidden on native, a background tab on the web.
+    bool isHidden() const
+    {
+#ifdef __EMSCRIPTEN__
+        auto visibilityStatus = EmscriptenVisibilityChangeEvent();
+
+        return
+            emscripten_get_visibility_status(&visibilityStatus)
+                    == EMSCRIPTEN_RESULT_SUCCESS
+                && visibilityStatus.hidden;
+#else
+        return
+            !this->headless
+                && (glfwGetWindowAttrib(this->window.get(), GLFW_ICONIFIED)
+                    || !glfwGetWindowAttrib(this->window.get(), GLFW_VISIBLE));
+#endif
+    }
+
 private:
+    bool headless;
     std::shared_ptr<GLFWwindow> window;
 };
 
@@ -4,40 +4,146 @@
 // =============================================================================
 
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <fstream>
 #include <iostream>
+#include <new>
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten/emscripten.h>
+#include <emscripten/heap.h>
 #endif
 
-#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <utility>
 
 #include "Window/WindowSystem.h"
 
+#include "Application/CommandLineArguments.h"
 #include "RubiksCubeMtl.h"
 #include "RubiksCubeObj.h"
+#include "RubiksCubeScene.h"
 #include "Graphics/Camera/Camera.h"
+#include "Graphics/Model/AssetPack.h"
 #include "Graphics/Model/Mesh/Mesh.h"
+#include "Graphics/Model/Mesh/PartitionedMeshData.h"
 #include "Graphics/Model/Model.h"
+#include "Graphics/Rendering/FramePacket.h"
 #include "Graphics/Rendering/Renderer.h"
 #include "Graphics/Rendering/ProjectionMatrixManager.h"
+#include "Graphics/Rendering/RedrawScheduler.h"
+#include "Input/InputLatencyTracker.h"
+#include "Input/InputRecording.h"
 #include "Input/InputSystem.h"
+#include "Input/SyntheticInputInjector.h"
+#include "Memory/AllocationTracker.h"
+#include "Serialization/MappedFile.h"
+#include "Simulation/FaceTurnAnimator.h"
 #include "Simulation/FixedRateTimer.h"
-#include "Simulation/SimulationObject.h"
+#include "Simulation/FixedTimestep.h"
+#include "Simulation/Scene.h"
+#include "Simulation/SceneDescription.h"
+#include "Threading/JobSystem.h"
+#include "Threading/TripleBuffer.h"
+#include "Threading/WakeSignal.h"
 
 
+#ifdef TRACK_ALLOCATIONS
+#ifdef __EMSCRIPTEN__
+// operator new calls malloc, so replacing malloc counts allocations made
+// from C as well. calloc and realloc go uncounted.
+extern "C" void* malloc(size_t size)
+{
+    ctoAssetsRTIS::AllocationTracker::recordAllocation(size);
+    return emscripten_builtin_malloc(size);
+}
+#else
+// The array and nothrow forms call these.
+void* operator new(size_t size)
+{
+    ctoAssetsRTIS::AllocationTracker::recordAllocation(size);
+
+    if (auto* data = std::malloc(size > 0 ? size : 1))
+    {
+        return data;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    ctoAssetsRTIS::AllocationTracker::recordAllocation(size);
+
+    const auto alignmentValue = static_cast<size_t>(alignment);
+#ifdef _WIN32
+    auto* data = _aligned_malloc(size > 0 ? size : 1, alignmentValue);
+#else
+    // aligned_alloc needs the size to be a multiple of the alignment.
+    auto* data =
+        std::aligned_alloc(
+            alignmentValue,
+            std::max(
+                (size + alignmentValue - 1) & ~(alignmentValue - 1),
+                alignmentValue));
+#endif
+
+    if (data)
+    {
+        return data;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* data) noexcept
+{
+    std::free(data);
+}
+
+void operator delete(void* data, size_t) noexcept
+{
+    std::free(data);
+}
+
+void operator delete(void* data, std::align_val_t) noexcept
+{
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    std::free(data);
+#endif
+}
+
+void operator delete(void* data, size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(data, alignment);
+}
+#endif
+#endif
+
 namespace ctoAssetsRTIS
 {
+// Takes the frame logic as its own type rather than erased, so each frame
+// is one direct call the compiler can see through and inline.
 struct MainLoop
 {
     struct Configuration
     {
         const InputSystem& inputSystem;
-        std::function<void()> logic;
     };
-    void operator()(Configuration configuration)
+    template<typename Logic>
+    void operator()(Configuration configuration, Logic&& logic)
     {
-        auto& [inputSystem, logic] = configuration;
+        const auto& [inputSystem] = configuration;
 
 #ifndef __EMSCRIPTEN__
         while (!inputSystem.isExitRequested())
@@ -45,32 +151,26 @@ struct MainLoop
             logic();
         }
 #else
+        static_cast<void>(inputSystem);
+
         auto wrappedLogic =
-            std::function<void()>
+        [&]
+        {
+            try
             {
-                [&]
-                {
-                    try
-                    {
-                        logic();
-                    }
-                    catch (const std::exception& exception)
-                    {
-                        emscripten_cancel_main_loop();
-                        throw exception;
-                    }
-                }
-            };
+                logic();
+            }
+            catch (const std::exception&)
+            {
+                emscripten_cancel_main_loop();
+                throw;
+            }
+        };
 
         emscripten_set_main_loop_arg(
-            [](void* functionPointer)
+            [](void* wrappedLogicPointer)
             {
-                auto& function =
-                    *reinterpret_cast<
-                        std::function<void()>*
-                    >(functionPointer);
-
-                function();
+                (*static_cast<decltype(wrappedLogic)*>(wrappedLogicPointer))();
             },
             &wrappedLogic,
             0,
@@ -80,19 +180,91 @@ struct MainLoop
 };
 } // namespace ctoAssetsRTIS
 
-int main()
+int main(int argc, char* argv[])
 {
     using namespace ctoAssetsRTIS;
 
     try
     {
+        const auto commandLineArguments =
+            CommandLineArguments::parse(
+                std::span(argv, static_cast<size_t>(argc)));
+
+        auto runtimeMeshSource = std::optional<RuntimeDeserialize<Mesh>>();
+        auto runtimeMaterialLibrarySource =
+            std::optional<RuntimeDeserialize<MaterialLibrary>>();
+
+        auto assetPackFile = std::optional<MappedFile>();
+#ifdef __EMSCRIPTEN__
+        const auto preloadedAssetPack = PreloadedAssetPack();
+#endif
+        auto assetPack = std::optional<AssetPack>();
+
+#ifdef __EMSCRIPTEN__
+        if (!preloadedAssetPack.getBytes().empty())
+        {
+            assetPack.emplace(preloadedAssetPack.getBytes());
+        }
+#else
+        if (commandLineArguments.modelPath)
+        {
+            runtimeMeshSource.emplace(
+                MappedFile({
+                    .path = commandLineArguments.modelPath
+                }).getView());
+            runtimeMaterialLibrarySource.emplace(
+                MappedFile({
+                    .path = commandLineArguments.materialLibraryPath
+                }).getView());
+        }
+
+        if (commandLineArguments.assetPackPath)
+        {
+            assetPackFile.emplace(
+                MappedFile::Properties{
+                    .path = commandLineArguments.assetPackPath
+                });
+            assetPack.emplace(assetPackFile->getBytes());
+        }
+
+        if (commandLineArguments.bakeAssetPackPath)
+        {
+            auto stream =
+                std::ofstream(
+                    commandLineArguments.bakeAssetPackPath,
+                    std::ios::binary);
+
+            AssetPack::write(
+                stream,
+                assetPack
+                    ? assetPack->getMeshData()
+                    : runtimeMeshSource
+                        ? runtimeMeshSource->getValue()
+                        : CompileTimeDeserialize<
+                            Mesh,
+                            fileContents::RubiksCubeObj
+                        >::value,
+                assetPack
+                    ? assetPack->getMaterialDefinitions()
+                    : runtimeMaterialLibrarySource
+                        ? runtimeMaterialLibrarySource->getValue()
+                        : CompileTimeDeserialize<
+                            MaterialLibrary,
+                            fileContents::RubiksCubeMtl
+                        >::value.getDefinitions());
+
+            return 0;
+        }
+#endif
+
         auto projectionMatrixManager = ProjectionMatrixManager();
 
         const auto windowSystem =
             WindowSystem({
                 .title = "cto-assets-rtis",
                 .viewportDimensions =
-                    projectionMatrixManager.getViewportDimensions()
+                    projectionMatrixManager.getViewportDimensions(),
+                .headless = commandLineArguments.allocationCheckFrameCount > 0
             });
 
         auto inputSystem =
@@ -116,55 +288,676 @@ int main()
             .window = windowSystem.getWindow().get()
         });
 
-        const auto rubiksCubeModel =
-            Model
+        const auto& rubiksCubePartition =
+            CompileTimeDeserialize<
+                PartitionedMeshData,
+                fileContents::RubiksCubeObj
+            >::value;
+
+        const auto isRubiksCubePartitioned =
+            !assetPack
+                && !(runtimeMeshSource && runtimeMaterialLibrarySource);
+
+        const auto makeModel =
+        [&]
+        {
+            if (assetPack)
+            {
+                return
+                    Model
+                    {
+                        .mesh = Mesh(assetPack->getMeshData()),
+                        .materialLibrary =
+                            MaterialLibrary(
+                                assetPack->getMaterialDefinitions())
+                    };
+            }
+
+            if (runtimeMeshSource && runtimeMaterialLibrarySource)
             {
-                .mesh = deserialize<Mesh, fileContents::RubiksCubeObj>(),
-                .materialLibrary =
-                    deserialize<MaterialLibrary, fileContents::RubiksCubeMtl>()
-            };
+                return
+                    Model
+                    {
+                        .mesh = deserialize(*runtimeMeshSource),
+                        .materialLibrary =
+                            deserialize(*runtimeMaterialLibrarySource)
+                    };
+            }
+
+            return
+                Model
+                {
+                    .mesh = Mesh(rubiksCubePartition.meshData),
+                    .materialLibrary =
+                        deserialize<
+                            MaterialLibrary,
+                            fileContents::RubiksCubeMtl
+                        >()
+                };
+        };
+
+        const auto startupAllocations = AllocationTracker::getCounts();
+        const auto rubiksCubeModel = makeModel();
+        const auto meshUploadAllocations =
+            AllocationTracker::getCounts() - startupAllocations;
 
-        const auto simulationObjects =
-            std::to_array({
-                SimulationObject
+        const auto modelBindings =
+            std::to_array<Scene::ModelBinding>({
                 {
+                    .name = "RubiksCube",
                     .model = rubiksCubeModel,
-                    .transform = Transform({ .scale = glm::vec3(0.075f) })
+                    .instances =
+                        isRubiksCubePartitioned
+                            ? rubiksCubePartition.instances
+                            : std::span<const MeshInstance>(),
+                    .bvh =
+                        isRubiksCubePartitioned
+                            ? &CompileTimeDeserialize<
+                                PartitionedMeshData,
+                                fileContents::RubiksCubeObj
+                            >::bvh
+                            : nullptr
                 }
             });
 
-        auto renderer = Renderer({
-            .camera = camera,
-            .projectionMatrixManager = projectionMatrixManager
-        });
+        auto scene =
+            Scene({
+                .description =
+                    CompileTimeDeserialize<
+                        SceneDescription,
+                        fileContents::RubiksCubeScene
+                    >::value,
+                .modelBindings = modelBindings
+            });
+
+        auto faceTurnAnimator =
+            FaceTurnAnimator({
+                .transformStore = scene.getTransformStore(),
+                .cubieSpacing = 2.0f,
+                .turnDuration = 250.0f
+            });
+
+        const auto dynamicObjects = scene.getDynamicObjects();
+        for (const auto& instanceGroup : scene.getInstanceGroups())
+        {
+            for (const auto& cubie :
+                dynamicObjects.subspan(
+                    instanceGroup.firstObject,
+                    instanceGroup.objectCount))
+            {
+                faceTurnAnimator.addCubie(cubie.transformIndex);
+            }
+        }
+
+        if (!scene.getInstanceGroups().empty())
+        {
+            faceTurnAnimator.enqueueScramble(20, 2024, 250.0f);
+        }
+
+        const auto shaderCompileStartAllocations =
+            AllocationTracker::getCounts();
+        auto renderer = Renderer();
+        const auto shaderCompileAllocations =
+            AllocationTracker::getCounts() - shaderCompileStartAllocations;
+
+        auto frameTimeReportFile = std::optional<std::ofstream>();
+        auto* frameTimeReportStream = static_cast<std::ostream*>(nullptr);
+        if (commandLineArguments.frameTimeReportPath)
+        {
+            if (std::string_view(commandLineArguments.frameTimeReportPath)
+                == "-")
+            {
+                frameTimeReportStream = &std::cerr;
+            }
+            else
+            {
+                frameTimeReportStream =
+                    &frameTimeReportFile.emplace(
+                        commandLineArguments.frameTimeReportPath);
+                if (!*frameTimeReportFile)
+                {
+                    throw std::runtime_error(
+                        std::format(
+                            "Failed to open {}",
+                            commandLineArguments.frameTimeReportPath));
+                }
+            }
+        }
+
+        if (AllocationTracker::isEnabled())
+        {
+            (frameTimeReportStream ? *frameTimeReportStream : std::cerr)
+                << std::format(
+                    "allocations startup {} ({} B) | mesh upload {} ({} B)"
+                    " | shader compile {} ({} B)\n",
+                    startupAllocations.allocationCount,
+                    startupAllocations.byteCount,
+                    meshUploadAllocations.allocationCount,
+                    meshUploadAllocations.byteCount,
+                    shaderCompileAllocations.allocationCount,
+                    shaderCompileAllocations.byteCount);
+        }
+
+        // Paces and measures presented frames, at the display's refresh
+        // rate where it is known, so frames interpolated between simulation
+        // steps are not held to the step rate.
+        const auto refreshRate = windowSystem.getRefreshRate();
+        auto timer =
+            FixedRateTimer<float>({
+                .targetFPS = refreshRate > 0.0f ? refreshRate : 60.0f,
+                .vsyncRefreshRate = refreshRate,
+                .reportStream = frameTimeReportStream
+            });
+
+        auto latencyTracker = std::optional<InputLatencyTracker>();
+        if (commandLineArguments.measureLatency)
+        {
+            // Reports from the thread that draws, as the timer does.
+            latencyTracker.emplace(
+                InputLatencyTracker::Configuration{
+                    .reportStream =
+                        frameTimeReportStream
+                            ? frameTimeReportStream
+                            : &std::cerr
+                });
+        }
+
+        auto syntheticInputInjector =
+            std::optional<SyntheticInputInjector>();
+        // An allocation check runs unattended, so it drives the camera.
+        if (commandLineArguments.syntheticInput
+            || commandLineArguments.allocationCheckFrameCount > 0)
+        {
+            const auto viewportDimensions =
+                projectionMatrixManager.getViewportDimensions();
+            const auto viewportSize =
+                glm::vec2(
+                    viewportDimensions.getWidth(),
+                    viewportDimensions.getHeight());
+
+            syntheticInputInjector.emplace(
+                SyntheticInputInjector::Configuration{
+                    .inputSystem = inputSystem,
+                    .center = viewportSize * 0.5f,
+                    .radius = std::min(viewportSize.x, viewportSize.y) * 0.25f,
+                    .period = 2000.0f,
+                    .sampleRate = 1000.0f
+                });
+        }
+
+        auto jobSystem = JobSystem({});
+
+        auto fixedTimestep =
+            FixedTimestep({
+                .stepDuration = 1000.0f / 60.0f,
+                .maximumStepsPerFrame = 8
+            });
+
+        auto inputRecordingFile = std::optional<std::ofstream>();
+        auto inputRecorder = std::optional<InputRecorder>();
+        auto inputReplayFile = std::optional<MappedFile>();
+        auto inputReplay = std::optional<InputReplay>();
+#ifndef __EMSCRIPTEN__
+        if (commandLineArguments.recordInputPath)
+        {
+            inputRecordingFile.emplace(
+                commandLineArguments.recordInputPath,
+                std::ios::binary);
+            if (!*inputRecordingFile)
+            {
+                throw std::runtime_error(
+                    std::format(
+                        "Failed to open {}",
+                        commandLineArguments.recordInputPath));
+            }
+
+            inputRecorder.emplace(
+                InputRecorder::Configuration{
+                    .stream = *inputRecordingFile,
+                    .stepDuration = fixedTimestep.getStepDuration(),
+                    .maximumStepsPerFrame =
+                        fixedTimestep.getMaximumStepsPerFrame()
+                });
+        }
+
+        if (commandLineArguments.replayInputPath)
+        {
+            inputReplayFile.emplace(
+                MappedFile::Properties{
+                    .path = commandLineArguments.replayInputPath
+                });
+            inputReplay.emplace(inputReplayFile->getBytes());
+
+            if (inputReplay->getStepDuration()
+                    != fixedTimestep.getStepDuration()
+                || inputReplay->getMaximumStepsPerFrame()
+                    != fixedTimestep.getMaximumStepsPerFrame())
+            {
+                throw std::runtime_error(
+                    "Input recording was made with a different timestep");
+            }
+        }
+#endif
+
+        auto allocationCheck = std::optional<AllocationCheck>();
+#ifndef __EMSCRIPTEN__
+        if (commandLineArguments.allocationCheckFrameCount > 0)
+        {
+            allocationCheck.emplace(
+                AllocationCheck::Configuration{
+                    .frameCount =
+                        commandLineArguments.allocationCheckFrameCount
+                });
+        }
+#endif
+
+        auto redrawScheduler =
+            RedrawScheduler({
+                .idleFrameInterval = std::numeric_limits<float>::infinity(),
+                .hiddenFrameInterval = 1000.0f
+            });
+
+        // The simulation keeps its own projection for culling, following the
+        // viewport the window reports.
+        auto simulationProjectionMatrixManager = ProjectionMatrixManager();
+
+        auto animating = false;
+        // Once a replay or an allocation check has run its course.
+        auto runComplete = false;
+        auto pendingLatencySample =
+            std::optional<FramePacket::LatencySample>();
+
+        // Simulates a frame of the given duration from the input queued so
+        // far and, if the frame is to be drawn, captures it into framePacket
+        // and returns true.
+        const auto simulateFrame =
+        [&](
+            FramePacket& framePacket,
+            float measuredFrameDuration,
+            ViewportDimensions windowViewportDimensions,
+            bool hidden)
+        {
+            // Drained as late as possible before the camera reads it.
+            inputSystem.processEvents(windowViewportDimensions);
+
+            if (simulationProjectionMatrixManager.getViewportDimensions()
+                != windowViewportDimensions)
+            {
+                simulationProjectionMatrixManager.setViewportDimensions(
+                    windowViewportDimensions);
+            }
+
+            // A replay stands in for live input and frame timing alike, so
+            // the same steps run on the same input.
+            auto replayFrame = std::optional<InputReplay::Frame>();
+            if (inputReplay)
+            {
+                replayFrame = inputReplay->nextFrame();
+                if (!replayFrame)
+                {
+                    runComplete = true;
+                    return false;
+                }
+            }
 
-        auto timer = FixedRateTimer<float>({ .targetFPS = 60.0f });
+            const auto frameDuration =
+                replayFrame
+                    ? replayFrame->frameDuration
+                    : measuredFrameDuration;
+            const auto viewportDimensions =
+                replayFrame
+                    ? replayFrame->viewportDimensions
+                    : windowViewportDimensions;
+
+            auto stepIndex = size_t{};
+            const auto stepCount =
+                fixedTimestep.advance(
+                    frameDuration,
+                    [&](float dt)
+                    {
+                        if (replayFrame
+                            && stepIndex == replayFrame->steps.size())
+                        {
+                            throw std::runtime_error(
+                                "Input replay diverged from recording");
+                        }
+
+                        scene.getTransformStore().beginStep();
+
+                        const auto& inputStates =
+                            replayFrame
+                                ? replayFrame->steps[stepIndex]
+                                : inputSystem.getStates();
+                        stepIndex++;
+
+                        camera.update({
+                            .inputStates = inputStates,
+                            .viewportDimensions = viewportDimensions,
+                            .dt = dt
+                        });
+
+                        if (inputRecorder)
+                        {
+                            inputRecorder->recordStep(inputStates);
+                        }
+
+                        const auto& mouseStates = inputStates.mouseStates;
+                        if (commandLineArguments.measureLatency
+                            && !replayFrame
+                            && !pendingLatencySample
+                            && (mouseStates.buttonPressed
+                                || mouseStates.touchActive)
+                            && mouseStates.cursorMotion != glm::vec2())
+                        {
+                            pendingLatencySample =
+                                FramePacket::LatencySample
+                                {
+                                    .inputTimestamp =
+                                        mouseStates.cursorMotionTimestamp,
+                                    .updateTimestamp =
+                                        FixedRateTimer<float>
+                                            ::getTotalElapsedTimeMilliseconds()
+                                            .count()
+                                };
+                        }
+                        inputSystem.clearCursorMotion();
+
+                        faceTurnAnimator.update(dt);
+                    });
+
+            if (replayFrame && stepCount != replayFrame->steps.size())
+            {
+                throw std::runtime_error(
+                    "Input replay diverged from recording");
+            }
+
+            if (inputRecorder)
+            {
+                inputRecorder->endFrame({
+                    .frameDuration = frameDuration,
+                    .viewportDimensions = viewportDimensions
+                });
+            }
+
+            const auto interpolationFactor =
+                fixedTimestep.getInterpolationFactor();
+
+            camera.setInterpolationFactor(interpolationFactor);
+            scene.updateModelMatrices(interpolationFactor, &jobSystem);
+
+            // A replay counts as animating until it ends: live input, which
+            // it ignores, would otherwise be all that ended an idle wait, and
+            // its frames are to run back to back.
+            animating =
+                inputReplay.has_value()
+                    || !camera.isAtRest()
+                    || camera.hasViewChanged()
+                    || !faceTurnAnimator.isIdle()
+                    || scene.getTransformStore().isInterpolating()
+                    || !scene.getTransformStore()
+                        .getUpdatedIndices()
+                        .empty();
+
+            if (animating
+                || inputSystem.hasChanged()
+                || simulationProjectionMatrixManager.wasUpdated())
+            {
+                redrawScheduler.requestRedraw();
+            }
+
+            const auto now =
+                FixedRateTimer<float>::getTotalElapsedTimeMilliseconds()
+                    .count();
+
+            if (!redrawScheduler.shouldRender({
+                .now = now,
+                .hidden = hidden
+            }))
+            {
+                return false;
+            }
+
+            framePacket.capture({
+                .scene = scene,
+                .viewMatrix = camera.getViewMatrix(),
+                .projectionMatrix =
+                    simulationProjectionMatrixManager.getMatrix()
+            });
+            framePacket.latencySample =
+                std::exchange(pendingLatencySample, std::nullopt);
+
+            return true;
+        };
+
+        const auto renderFrame =
+        [&](const FramePacket& framePacket)
+        {
+            if (latencyTracker && framePacket.latencySample)
+            {
+                latencyTracker->recordUpdate(
+                    framePacket.latencySample->inputTimestamp,
+                    framePacket.latencySample->updateTimestamp);
+            }
 
-        MainLoop{}({
-            .inputSystem = inputSystem,
-            .logic =
+            windowSystem.clearScreen();
+            renderer.render(framePacket);
+            if (latencyTracker)
+            {
+                latencyTracker->recordSubmit();
+            }
+            windowSystem.swapBuffers();
+
+            if (latencyTracker)
+            {
+                latencyTracker->recordPresent(true);
+            }
+        };
+
+#ifdef __EMSCRIPTEN__
+        auto framePacket = FramePacket();
+
+        MainLoop{}(
+            { .inputSystem = inputSystem },
             [&]
             {
                 timer.startFrame();
 
-                windowSystem.clearScreen();
+                if (syntheticInputInjector)
+                {
+                    syntheticInputInjector->update(
+                        FixedRateTimer<float>::getTotalElapsedTimeMilliseconds()
+                            .count());
+                }
+
+                inputSystem.pollEvents();
 
-                camera.update({
-                    .inputStates = inputSystem.getStates(),
-                    .viewportDimensions =
+                const auto presented =
+                    simulateFrame(
+                        framePacket,
+                        timer.getDeltaTime(),
                         projectionMatrixManager.getViewportDimensions(),
-                    .dt = timer.getDeltaTime()
+                        windowSystem.isHidden());
+
+                if (presented)
+                {
+                    renderFrame(framePacket);
+                }
+
+                timer.endFrame({ .presented = presented });
+            });
+#else
+        // This thread handles the window and draws; simulation runs on its
+        // own thread and hands each frame to be drawn over in a packet, so
+        // a slow swap stalls only drawing. Taking a packet starts the next
+        // one, so one frame is simulated per frame presented, at whatever
+        // rate the display runs, and its step interpolation follows. The
+        // latest packet wins: frames simulated faster than they are drawn,
+        // as on input, are skipped.
+        auto framePackets = TripleBuffer<FramePacket>();
+        auto simulationWakeSignal = WakeSignal();
+        auto windowViewportDimensions =
+            std::atomic<ViewportDimensions>(
+                projectionMatrixManager.getViewportDimensions());
+        auto windowHidden = std::atomic<bool>(windowSystem.isHidden());
+        auto simulationFinished = std::atomic<bool>(false);
+        auto simulationException = std::exception_ptr();
+
+        auto simulationThread =
+            std::jthread(
+                [&](std::stop_token stopToken)
+                {
+                    try
+                    {
+                        // Only the fixed steps are timed here; the timer
+                        // measures presented frames on the drawing thread.
+                        const auto getNow =
+                        []
+                        {
+                            return
+                                FixedRateTimer<float>
+                                    ::getTotalElapsedTimeMilliseconds()
+                                    .count();
+                        };
+
+                        auto previousFrameStart = getNow();
+                        while (!stopToken.stop_requested() && !runComplete)
+                        {
+                            const auto frameStart = getNow();
+                            const auto frameDuration =
+                                static_cast<float>(
+                                    frameStart - previousFrameStart);
+                            previousFrameStart = frameStart;
+
+                            const auto published =
+                                simulateFrame(
+                                    framePackets.getBackBuffer(),
+                                    frameDuration,
+                                    windowViewportDimensions.load(),
+                                    windowHidden.load());
+
+                            if (published)
+                            {
+                                framePackets.publish();
+                                inputSystem.interruptWait();
+                            }
+
+                            // Steady once the scramble is done and only the
+                            // camera moves.
+                            if (allocationCheck
+                                && allocationCheck->endFrame({
+                                    .steady = faceTurnAnimator.isIdle()
+                                }))
+                            {
+                                runComplete = true;
+                            }
+
+                            const auto timeUntilNextFrame =
+                                redrawScheduler.getTimeUntilNextFrame(
+                                    getNow());
+
+                            if (published)
+                            {
+                                // Until the packet is taken, or new input.
+                                simulationWakeSignal.waitFor(
+                                    std::numeric_limits<float>::infinity(),
+                                    stopToken);
+                            }
+                            else if (timeUntilNextFrame > 0.0f)
+                            {
+                                simulationWakeSignal.waitFor(
+                                    timeUntilNextFrame,
+                                    stopToken);
+
+                                // Idle time is kept out of the next frame's
+                                // duration.
+                                if (!animating)
+                                {
+                                    previousFrameStart = getNow();
+                                }
+                            }
+                        }
+                    }
+                    catch (...)
+                    {
+                        simulationException = std::current_exception();
+                    }
+
+                    simulationFinished.store(true, std::memory_order_release);
+                    inputSystem.interruptWait();
                 });
 
-                renderer.render({ simulationObjects });
+        MainLoop{}(
+            { .inputSystem = inputSystem },
+            [&]
+            {
+                if (simulationFinished.load(std::memory_order_acquire))
+                {
+                    inputSystem.requestExit();
+                    return;
+                }
+
+                if (framePackets.acquire())
+                {
+                    timer.startFrame();
 
-                windowSystem.swapBuffers();
+                    // The next packet is simulated while this one is drawn.
+                    simulationWakeSignal.notify();
+                    renderFrame(framePackets.getFrontBuffer());
 
-                inputSystem.pollEvents();
+                    timer.endFrame({ .presented = true });
+                }
+
+                // Ended by input or by a newly published packet. Synthetic
+                // samples fall due without either, so they are checked for
+                // every millisecond.
+                inputSystem.waitEvents(
+                    syntheticInputInjector
+                        ? 1.0f
+                        : std::numeric_limits<float>::infinity());
+
+                if (syntheticInputInjector)
+                {
+                    syntheticInputInjector->update(
+                        FixedRateTimer<float>::getTotalElapsedTimeMilliseconds()
+                            .count());
+                }
+
+                windowViewportDimensions.store(
+                    projectionMatrixManager.getViewportDimensions());
+                windowHidden.store(windowSystem.isHidden());
+                simulationWakeSignal.notify();
+            });
+
+        simulationThread.request_stop();
+        simulationThread.join();
 
-                timer.endFrame();
+        if (simulationException)
+        {
+            std::rethrow_exception(simulationException);
+        }
+#endif
+
+        if (frameTimeReportStream)
+        {
+            timer.writeReport(*frameTimeReportStream);
+        }
+
+        if (latencyTracker)
+        {
+            latencyTracker->writeReport(
+                frameTimeReportStream ? *frameTimeReportStream : std::cerr);
+        }
+
+        if (allocationCheck)
+        {
+            allocationCheck->writeReport(
+                frameTimeReportStream ? *frameTimeReportStream : std::cerr);
+
+            if (!allocationCheck->hasPassed())
+            {
+                return -1;
             }
-        });
+        }
     }
     catch (const std::exception& exception)
     {
@@ -0,0 +1,234 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "RubiksCubeObj.h"
+#include "Graphics/Model/Mesh/MeshData.h"
+#include "Serialization/StreamEncoding.h"
+
+
+namespace ctoAssetsRTIS
+{
+namespace
+{
+using RubiksCubeMesh =
+    CompileTimeDeserialize<Mesh, fileContents::RubiksCubeObj>;
+
+template<MeshProcessingOptions Options>
+using ProcessedRubiksCubeMesh =
+    CompileTimeDeserialize<
+        Mesh,
+        ProcessedWith<fileContents::RubiksCubeObj, Options>
+    >;
+
+// Stream encoding: decoding the encoded streams gives back the originals.
+using EncodedRubiksCubeMesh =
+    ProcessedRubiksCubeMesh<MeshProcessingOptions{ .encodeStreams = true }>;
+
+template<auto& Expected, typename Word>
+constexpr bool decodesTo(const EncodedStream<Word>& encodedStream)
+{
+    auto words = std::array<Word, Expected.size()>{};
+    StreamEncoding::decode(encodedStream, std::span<Word>(words));
+
+    return words == Expected;
+}
+
+static_assert(
+    decodesTo<RubiksCubeMesh::vertices>(EncodedRubiksCubeMesh::value.vertices));
+static_assert(
+    decodesTo<RubiksCubeMesh::faceIndices>(
+        EncodedRubiksCubeMesh::value.faceIndices));
+
+// Hidden geometry removal: the cubies' inner faces go, the visible surface
+// and the material chunk layout stay.
+using RubiksCubeMeshWithoutHiddenGeometry =
+    ProcessedRubiksCubeMesh<
+        MeshProcessingOptions{ .removeHiddenGeometry = true }
+    >;
+
+static_assert(RubiksCubeMeshWithoutHiddenGeometry::hiddenTriangleCount == 1564);
+static_assert(
+    RubiksCubeMeshWithoutHiddenGeometry::faceIndices.size()
+        == (RubiksCubeMeshWithoutHiddenGeometry::parsedTriangleCount
+            - RubiksCubeMeshWithoutHiddenGeometry::hiddenTriangleCount) * 3);
+static_assert(
+    RubiksCubeMeshWithoutHiddenGeometry::vertices.size()
+        == 2124 * RubiksCubeMesh::VertexType::elementCount);
+
+template<typename ProcessedMesh>
+constexpr bool indicesAreInRange()
+{
+    const auto vertexCount =
+        ProcessedMesh::vertices.size()
+            / ProcessedMesh::VertexType::elementCount;
+
+    return
+        std::ranges::all_of(
+            ProcessedMesh::faceIndices,
+            [&](GLuint index) { return index < vertexCount; });
+}
+
+static_assert(indicesAreInRange<RubiksCubeMeshWithoutHiddenGeometry>());
+
+constexpr bool preservesMaterialChunkLayout()
+{
+    constexpr auto& parsedChunks = RubiksCubeMesh::materialChunks;
+    constexpr auto& chunks =
+        RubiksCubeMeshWithoutHiddenGeometry::materialChunks;
+
+    if (chunks.size() != parsedChunks.size())
+    {
+        return false;
+    }
+
+    auto offset = size_t{};
+    for (auto i = size_t{}; i < chunks.size(); i++)
+    {
+        if (chunks[i].name != parsedChunks[i].name
+            || chunks[i].offset != offset
+            || chunks[i].count == 0
+            || chunks[i].count > parsedChunks[i].count
+            || chunks[i].count % 3 != 0)
+        {
+            return false;
+        }
+
+        offset += chunks[i].count;
+    }
+
+    return offset == RubiksCubeMeshWithoutHiddenGeometry::faceIndices.size();
+}
+
+static_assert(preservesMaterialChunkLayout());
+
+// Triangle strips: fewer indices, and every triangle a strip renders, with
+// the strip's alternating winding, is a rotation of exactly one original
+// triangle of the same chunk.
+using StrippedRubiksCubeMesh =
+    ProcessedRubiksCubeMesh<
+        MeshProcessingOptions{ .stripifyTriangles = true }
+    >;
+
+template<typename MaterialChunk>
+constexpr bool stripsReproduceTriangles(
+    std::span<const GLuint> triangleIndices,
+    std::span<const MaterialChunk> triangleChunks,
+    std::span<const GLuint> stripIndices,
+    std::span<const MaterialChunk> stripChunks)
+{
+    if (stripChunks.size() != triangleChunks.size())
+    {
+        return false;
+    }
+
+    auto used = std::vector<bool>(triangleIndices.size() / 3);
+
+    const auto claim =
+    [&](const MaterialChunk& triangleChunk, std::array<GLuint, 3> corners)
+    {
+        const auto firstTriangle = triangleChunk.offset / 3;
+        const auto endTriangle = firstTriangle + triangleChunk.count / 3;
+
+        for (auto triangle = firstTriangle; triangle < endTriangle; triangle++)
+        {
+            for (auto rotation = size_t{}; rotation < 3; rotation++)
+            {
+                auto matches = !used[triangle];
+                for (auto corner = size_t{}; corner < 3; corner++)
+                {
+                    matches =
+                        matches
+                            && corners[corner]
+                                == triangleIndices[
+                                    triangle * 3 + (rotation + corner) % 3];
+                }
+
+                if (matches)
+                {
+                    used[triangle] = true;
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    };
+
+    for (auto chunk = size_t{}; chunk < stripChunks.size(); chunk++)
+    {
+        const auto indices =
+            stripIndices.subspan(
+                stripChunks[chunk].offset,
+                stripChunks[chunk].count);
+
+        if (stripChunks[chunk].primitiveMode == GL_TRIANGLES)
+        {
+            if (indices.size() % 3 != 0)
+            {
+                return false;
+            }
+
+            for (auto i = size_t{}; i < indices.size(); i += 3)
+            {
+                if (!claim(
+                        triangleChunks[chunk],
+                        { indices[i], indices[i + 1], indices[i + 2] }))
+                {
+                    return false;
+                }
+            }
+
+            continue;
+        }
+
+        auto start = size_t{};
+        for (auto end = size_t{}; end <= indices.size(); end++)
+        {
+            if (end < indices.size()
+                && indices[end] != TriangleStrips::restartIndex)
+            {
+                continue;
+            }
+
+            for (auto i = start; i + 2 < end; i++)
+            {
+                const auto [a, b, c] =
+                    std::array{ indices[i], indices[i + 1], indices[i + 2] };
+
+                if (!claim(
+                        triangleChunks[chunk],
+                        (i - start) % 2 == 0
+                            ? std::array{ a, b, c }
+                            : std::array{ b, a, c }))
+                {
+                    return false;
+                }
+            }
+
+            start = end + 1;
+        }
+    }
+
+    return std::find(used.begin(), used.end(), false) == used.end();
+}
+
+static_assert(
+    StrippedRubiksCubeMesh::faceIndices.size()
+        < RubiksCubeMesh::faceIndices.size());
+static_assert(
+    stripsReproduceTriangles<MeshData::MaterialChunk>(
+        RubiksCubeMesh::faceIndices,
+        RubiksCubeMesh::materialChunks,
+        StrippedRubiksCubeMesh::faceIndices,
+        StrippedRubiksCubeMesh::materialChunks));
+} // namespace
+} // namespace ctoAssetsRTIS
@@ -0,0 +1,210 @@
+// =============================================================================
+// Copyright (C) 2024, Griffin Downs. All rights reserved.
+// This file is part of cto-assets-rtis. See LICENSE.md for details.
+// =============================================================================
+
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Window/WindowSystem.h"
+
+#include "RubiksCubeMtl.h"
+#include "RubiksCubeObj.h"
+#include "RubiksCubeScene.h"
+#include "Graphics/Model/Mesh/MeshBvh.h"
+#include "Graphics/Model/Mesh/PartitionedMeshData.h"
+#include "Graphics/Model/Model.h"
+#include "Simulation/DynamicAabbTree.h"
+#include "Simulation/Scene.h"
+#include "Simulation/SceneDescription.h"
+
+
+namespace ctoAssetsRTIS
+{
+namespace
+{
+void check(bool condition, std::string_view description)
+{
+    if (!condition)
+    {
+        throw
+            std::runtime_error(std::format("Check failed: {}", description));
+    }
+}
+
+// A scene in which no dynamic object has a bounding volume hierarchy
+// indexes none of them.
+void checkEmptyObjectTree()
+{
+    auto objectTree = DynamicAabbTree({ .rebuildThreshold = 1.5f });
+
+    objectTree.reset({});
+    objectTree.update();
+
+    auto visitedCount = size_t{};
+    objectTree.queryRay(
+        glm::vec3(0.0f, 0.0f, 1.0f),
+        glm::vec3(0.0f, 0.0f, -2.0f),
+        1.0f,
+        [&](size_t) { visitedCount++; });
+
+    check(objectTree.size() == 0, "the empty tree holds no objects");
+    check(visitedCount == 0, "the empty tree visits no objects");
+
+    const auto bounds =
+        std::to_array<DynamicAabbTree::Box>({
+            { .minimum = glm::vec3(-1.0f), .maximum = glm::vec3(1.0f) }
+        });
+    objectTree.reset(bounds);
+    objectTree.reset({});
+    objectTree.update();
+
+    check(objectTree.size() == 0, "a tree reset to empty holds no objects");
+}
+
+// A ray through the middle of a view looking down the cube's z axis hits
+// the cubie at the centre of the facing side.
+void checkPickHitsFacingCubie()
+{
+    const auto viewportDimensions =
+        ViewportDimensions({ .width = 800, .height = 600 });
+
+    // The meshes are uploaded, so a context is needed.
+    const auto windowSystem =
+        WindowSystem({
+            .title = "scene-checks",
+            .viewportDimensions = viewportDimensions,
+            .headless = true
+        });
+
+    const auto& rubiksCubePartition =
+        CompileTimeDeserialize<
+            PartitionedMeshData,
+            fileContents::RubiksCubeObj
+        >::value;
+
+    const auto rubiksCubeModel =
+        Model
+        {
+            .mesh = Mesh(rubiksCubePartition.meshData),
+            .materialLibrary =
+                deserialize<MaterialLibrary, fileContents::RubiksCubeMtl>()
+        };
+
+    const auto modelBindings =
+        std::to_array<Scene::ModelBinding>({
+            {
+                .name = "RubiksCube",
+                .model = rubiksCubeModel,
+                .instances = rubiksCubePartition.instances,
+                .bvh =
+                    &CompileTimeDeserialize<
+                        PartitionedMeshData,
+                        fileContents::RubiksCubeObj
+                    >::bvh
+            }
+        });
+
+    auto scene =
+        Scene({
+            .description =
+                CompileTimeDeserialize<
+                    SceneDescription,
+                    fileContents::RubiksCubeScene
+                >::value,
+            .modelBindings = modelBindings
+        });
+    scene.updateModelMatrices();
+
+    const auto modelMatrices = scene.getTransformStore().getModelMatrices();
+    const auto dynamicObjects = scene.getDynamicObjects();
+
+    // Among the cubies centred on the z axis, the one nearest the camera.
+    auto expectedObject = std::numeric_limits<size_t>::max();
+    auto expectedCentre = glm::vec3();
+    for (auto i = size_t{}; i < dynamicObjects.size(); i++)
+    {
+        const auto centre =
+            glm::vec3(modelMatrices[dynamicObjects[i].transformIndex][3]);
+
+        if (std::abs(centre.x) < 0.01f
+            && std::abs(centre.y) < 0.01f
+            && (expectedObject == std::numeric_limits<size_t>::max()
+                || centre.z > expectedCentre.z))
+        {
+            expectedObject = i;
+            expectedCentre = centre;
+        }
+    }
+
+    check(
+        expectedObject != std::numeric_limits<size_t>::max(),
+        "a cubie is centred on the z axis");
+
+    const auto viewMatrix =
+        glm::lookAt(
+            glm::vec3(0.0f, 0.0f, 1.0f),
+            glm::vec3(0.0f),
+            glm::vec3(0.0f, 1.0f, 0.0f));
+    const auto projectionMatrix =
+        glm::perspective(
+            glm::radians(45.0f),
+            static_cast<float>(viewportDimensions.getWidth())
+                / static_cast<float>(viewportDimensions.getHeight()),
+            0.1f,
+            10.0f);
+
+    const auto ray =
+        MeshBvh::Ray::fromCursor({
+            .cursorPosition =
+                glm::vec2(
+                    static_cast<float>(viewportDimensions.getWidth()) / 2.0f,
+                    static_cast<float>(viewportDimensions.getHeight()) / 2.0f),
+            .viewportDimensions = viewportDimensions,
+            .viewMatrix = viewMatrix,
+            .projectionMatrix = projectionMatrix
+        });
+
+    const auto pick = scene.pick(ray);
+
+    check(pick.has_value(), "the ray hits the cube");
+    check(pick->object == expectedObject, "the ray hits the facing cubie");
+    check(pick->materialChunk.has_value(), "the hit has a material chunk");
+    check(
+        pick->point.z > expectedCentre.z,
+        "the hit is on the facing side of the cubie");
+    check(
+        std::abs(pick->point.x) < 1e-4f && std::abs(pick->point.y) < 1e-4f,
+        "the hit is on the ray");
+}
+} // namespace
+} // namespace ctoAssetsRTIS
+
+int main()
+{
+    using namespace ctoAssetsRTIS;
+
+    try
+    {
+        checkEmptyObjectTree();
+        checkPickHitsFacingCubie();
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}